@@ -0,0 +1,137 @@
+#pragma once
+#include "afv-native/atcClientWrapper.h"
+#include "afv-native/event.h"
+#include "afv-native/hardwareType.h"
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace vector_audio {
+
+using ClientEventCallback
+    = std::function<void(afv_native::ClientEventType, void*, void*)>;
+
+// The part of the afv client VectorAudio uses. The app only talks to this, so
+// it can run against the real audio and network stack or against a mock.
+class AfvClient {
+public:
+    virtual ~AfvClient() = default;
+
+    virtual void SetCredentials(std::string username, std::string password) = 0;
+    virtual void SetCallsign(std::string callsign) = 0;
+    virtual void SetClientPosition(
+        double lat, double lon, double amslm, double aglm)
+        = 0;
+    virtual bool IsVoiceConnected() = 0;
+    virtual bool IsAPIConnected() = 0;
+    virtual bool Connect() = 0;
+    virtual void Disconnect() = 0;
+    virtual void SetAudioApi(unsigned int api) = 0;
+    virtual std::map<unsigned int, std::string> GetAudioApis() = 0;
+    virtual void SetAudioInputDevice(std::string inputDevice) = 0;
+    virtual std::vector<std::string> GetAudioInputDevices(
+        unsigned int mAudioApi)
+        = 0;
+    virtual void SetAudioOutputDevice(std::string outputDevice) = 0;
+    virtual void SetAudioSpeakersOutputDevice(std::string outputDevice) = 0;
+    virtual void SetHeadsetOutputChannel(int channel) = 0;
+    virtual std::vector<std::string> GetAudioOutputDevices(
+        unsigned int mAudioApi)
+        = 0;
+    virtual double GetInputPeak() = 0;
+    virtual double GetInputVu() = 0;
+    virtual void SetEnableInputFilters(bool enableInputFilters) = 0;
+    virtual void SetEnableOutputEffects(bool enableEffects) = 0;
+    virtual void StartAudio() = 0;
+    virtual void StopAudio() = 0;
+    virtual bool IsAudioRunning() = 0;
+    virtual void SetTx(unsigned int freq, bool active) = 0;
+    virtual void SetRx(unsigned int freq, bool active) = 0;
+    virtual void SetXc(unsigned int freq, bool active) = 0;
+    virtual void SetOnHeadset(unsigned int freq, bool active) = 0;
+    virtual bool GetTxActive(unsigned int freq) = 0;
+    virtual bool GetRxActive(unsigned int freq) = 0;
+    virtual bool GetOnHeadset(unsigned int freq) = 0;
+    virtual bool GetTxState(unsigned int freq) = 0;
+    virtual bool GetRxState(unsigned int freq) = 0;
+    virtual bool GetXcState(unsigned int freq) = 0;
+    virtual void UseTransceiversFromStation(std::string station, int freq) = 0;
+    virtual void FetchTransceiverInfo(std::string station) = 0;
+    virtual void FetchStationVccs(std::string station) = 0;
+    virtual void GetStation(std::string station) = 0;
+    virtual int GetTransceiverCountForStation(std::string station) = 0;
+    virtual void SetPtt(bool pttState) = 0;
+    virtual void StopAtisPlayback() = 0;
+    virtual bool IsAtisPlayingBack() = 0;
+    virtual std::string LastTransmitOnFreq(unsigned int freq) = 0;
+    virtual void SetRadiosGain(float gain) = 0;
+    virtual void AddFrequency(unsigned int freq, std::string stationName) = 0;
+    virtual void RemoveFrequency(unsigned int freq) = 0;
+    virtual bool IsFrequencyActive(unsigned int freq) = 0;
+    virtual void SetHardware(afv_native::HardwareType hardware) = 0;
+    virtual void RaiseClientEvent(ClientEventCallback callback) = 0;
+};
+
+// Forwards everything to afv_native
+class NativeAfvClient : public AfvClient {
+public:
+    NativeAfvClient(std::string clientName, std::string resourcePath);
+
+    void SetCredentials(std::string username, std::string password) override;
+    void SetCallsign(std::string callsign) override;
+    void SetClientPosition(
+        double lat, double lon, double amslm, double aglm) override;
+    bool IsVoiceConnected() override;
+    bool IsAPIConnected() override;
+    bool Connect() override;
+    void Disconnect() override;
+    void SetAudioApi(unsigned int api) override;
+    std::map<unsigned int, std::string> GetAudioApis() override;
+    void SetAudioInputDevice(std::string inputDevice) override;
+    std::vector<std::string> GetAudioInputDevices(
+        unsigned int mAudioApi) override;
+    void SetAudioOutputDevice(std::string outputDevice) override;
+    void SetAudioSpeakersOutputDevice(std::string outputDevice) override;
+    void SetHeadsetOutputChannel(int channel) override;
+    std::vector<std::string> GetAudioOutputDevices(
+        unsigned int mAudioApi) override;
+    double GetInputPeak() override;
+    double GetInputVu() override;
+    void SetEnableInputFilters(bool enableInputFilters) override;
+    void SetEnableOutputEffects(bool enableEffects) override;
+    void StartAudio() override;
+    void StopAudio() override;
+    bool IsAudioRunning() override;
+    void SetTx(unsigned int freq, bool active) override;
+    void SetRx(unsigned int freq, bool active) override;
+    void SetXc(unsigned int freq, bool active) override;
+    void SetOnHeadset(unsigned int freq, bool active) override;
+    bool GetTxActive(unsigned int freq) override;
+    bool GetRxActive(unsigned int freq) override;
+    bool GetOnHeadset(unsigned int freq) override;
+    bool GetTxState(unsigned int freq) override;
+    bool GetRxState(unsigned int freq) override;
+    bool GetXcState(unsigned int freq) override;
+    void UseTransceiversFromStation(std::string station, int freq) override;
+    void FetchTransceiverInfo(std::string station) override;
+    void FetchStationVccs(std::string station) override;
+    void GetStation(std::string station) override;
+    int GetTransceiverCountForStation(std::string station) override;
+    void SetPtt(bool pttState) override;
+    void StopAtisPlayback() override;
+    bool IsAtisPlayingBack() override;
+    std::string LastTransmitOnFreq(unsigned int freq) override;
+    void SetRadiosGain(float gain) override;
+    void AddFrequency(unsigned int freq, std::string stationName) override;
+    void RemoveFrequency(unsigned int freq) override;
+    bool IsFrequencyActive(unsigned int freq) override;
+    void SetHardware(afv_native::HardwareType hardware) override;
+    void RaiseClientEvent(ClientEventCallback callback) override;
+
+private:
+    std::unique_ptr<afv_native::api::atcClient> client_;
+};
+
+}
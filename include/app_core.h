@@ -0,0 +1,151 @@
+#pragma once
+#include "afv-native/event.h"
+#include "afv_client.h"
+#include "audio_device_registry.h"
+#include "config.h"
+#include "event_loop.h"
+#include "ns/airport.h"
+#include "sdk_socket_server.h"
+#include "shared.h"
+#include "stop_token.h"
+#include <atomic>
+#include <chrono>
+#include <data_file_handler.h>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <restinio/all.hpp>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace vector_audio::replay {
+class ReplayDriver;
+}
+
+namespace vector_audio::application {
+
+// Everything VectorAudio does that does not need a window: the afv client,
+// the VATSIM data handler, the SDK server and the station bookkeeping. The
+// GUI draws on top of it, and headless mode drives it on its own.
+class AppCore {
+public:
+    // Runs against the real afv client unless another one is given
+    explicit AppCore(std::unique_ptr<AfvClient> client = nullptr);
+    ~AppCore();
+
+    // Per-frame work, the GUI calls this once per frame and headless mode on a
+    // short timer
+    void tick();
+
+    // Starts audio and connects to AFV with the current session, returns
+    // false if that could not be started
+    bool connect();
+    void disconnect(bool manual);
+    bool isConnected() const;
+
+    // Adds a station by callsign, or a pilot on UNICOM if prefixed with !.
+    // Pilots are looked up in the background and added on a later tick.
+    void addStation(const std::string& callsign);
+
+    static bool frequencyExists(int freq);
+
+    // Errors meant for the user, they are only logged if no handler is set
+    void setErrorHandler(std::function<void(const std::string&)> handler);
+    // Called when the voice server drops us without the user asking for it
+    void setUnexpectedDisconnectHandler(std::function<void()> handler);
+
+    AfvClient* client() const { return mClient_.get(); }
+    vatsim::DataHandler* dataHandler() const { return dataHandler_.get(); }
+    AudioDeviceRegistry* audioDevices() const { return audioDevices_.get(); }
+
+    const std::vector<std::string>& receivedCallsigns() const
+    {
+        return receivedCallsigns_;
+    }
+
+private:
+    // Feeds recorded events straight into eventCallback()
+    friend class replay::ReplayDriver;
+
+    void reportError(const std::string& message);
+
+    void eventCallback(
+        afv_native::ClientEventType evt, void* data, void* data2);
+    // The body for an SDK request, whichever transport it came in on
+    std::string sdkResponse(bool is_get, std::string_view target);
+    void buildSDKServer();
+    // Waits for the server to stop listening and finish its requests
+    void closeSDKServer();
+
+    // The SDK only follows datafile changes while a client asks for them, as
+    // the polls then read the whole datafile. The subscription is dropped
+    // once no request came in for kSDKChangesIdle.
+    void subscribeSDKToChanges();
+    void dropIdleSDKSubscription();
+    void queueSDKChanges(const std::vector<vatsim::DatafileChange>& changes);
+    std::string sdkChangesSince(std::uint64_t since);
+
+    void addBootUpStation();
+    void processPendingStations();
+    // Adds the UNICOM stations for the pilot lookups that came back
+    void processPilotLookups();
+    void updateReceivedCallsigns();
+
+    // Used in another thread
+    static void loadAirportsDatabaseAsync(const StopToken& stop);
+
+    // Threads of the network loop, and of its pool for blocking requests. A
+    // poll, a pilot lookup and the probes it may trigger fit in the pool.
+    static constexpr std::size_t kNetworkThreads = 2;
+    static constexpr std::size_t kBlockingThreads = 3;
+
+    // A few polls, so a client that asks every poll or so stays subscribed
+    static constexpr auto kSDKChangesIdle = std::chrono::seconds(60);
+
+    // Declared first so it outlives everything that queues work on it
+    EventLoop loop_;
+
+    std::unique_ptr<AfvClient> mClient_;
+    std::unique_ptr<restinio::http_server_t<>> mSDKServer_;
+    std::unique_ptr<SDKSocketServer> mSDKSocket_;
+
+    std::unique_ptr<vector_audio::vatsim::DataHandler> dataHandler_;
+
+    // Datafile changes for the SDK, numbered so clients can ask for the ones
+    // they have not seen yet
+    std::mutex sdkSubscriptionMutex_;
+    int sdkChangesSubscription_ = -1;
+    std::chrono::steady_clock::time_point lastSDKChangesRequest_;
+    std::deque<std::pair<std::uint64_t, std::string>> sdkChanges_;
+    std::uint64_t nextSDKChange_ = 1;
+    std::mutex sdkChangesMutex_;
+    std::unique_ptr<AudioDeviceRegistry> audioDevices_;
+
+    // Pilots added with !, looked up on the network loop
+    struct PilotLookup {
+        std::string callsign;
+        bool found = false;
+        double latitude = 0.0;
+        double longitude = 0.0;
+    };
+    std::vector<PilotLookup> pilotLookups_;
+    std::mutex pilotLookupsMutex_;
+
+    // Stops the background tasks the core owns, before anything they use
+    // goes away
+    StopSource stop_;
+    std::thread airportLoader_;
+
+    std::function<void(const std::string&)> errorHandler_;
+    std::function<void()> unexpectedDisconnectHandler_;
+    bool manuallyDisconnected_ = false;
+
+    // Last callsigns heard on the stations we receive, and those transmitting
+    // right now
+    std::vector<std::string> receivedCallsigns_;
+    std::vector<std::string> liveReceivedCallsigns_;
+};
+}
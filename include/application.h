@@ -1,5 +1,5 @@
 #pragma once
-#include "afv-native/atcClientWrapper.h"
+#include "app_core.h"
 #include "config.h"
 #include "afv-native/event.h"
 #include "imgui.h"
@@ -26,36 +26,27 @@
 #include <utility>
 
 namespace vector_audio::application {
+// The windowed front end, it draws the main window on top of the core
 class App {
 public:
-    App();
+    explicit App(std::unique_ptr<AfvClient> client = nullptr);
     ~App();
 
     void render_frame();
 
-private:
-    static bool frequencyExists(int freq);
+    AppCore& core() { return *core_; }
 
+private:
     void errorModal(std::string message);
-
-    afv_native::api::atcClient* mClient_;
-    restinio::running_server_handle_t<restinio::default_traits_t> mSDKServer_;
-
-    void eventCallback(
-        afv_native::ClientEventType evt, void* data, void* data2);
-    void buildSDKServer();
-
-    // Used in another thread
-    static void loadAirportsDatabaseAsync();
+    void pollPtt();
 
     bool showErrorModal_ = false;
     std::string lastErrorModalMessage_;
 
-    std::unique_ptr<vector_audio::vatsim::DataHandler> dataHandler_;
-
     sf::SoundBuffer disconnectWarningSoundbuffer_;
     sf::Sound soundPlayer_;
-    bool disconnectWarningSoundAvailable_ = true;
-    bool manuallyDisconnected_ = false;
+
+    // Last, so it is torn down before the sound its callbacks play
+    std::unique_ptr<AppCore> core_;
 };
 }
\ No newline at end of file
@@ -0,0 +1,79 @@
+#pragma once
+#include "afv_client.h"
+#include "shared.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace vector_audio {
+using namespace std::chrono_literals;
+
+// Enumerates the audio APIs and devices in the background, as probing the OS
+// audio stack can take hundreds of milliseconds. The list is refreshed on
+// request and on a slow timer, so devices that are plugged in or removed
+// show up on their own.
+//
+// The afv client is not thread safe, so the worker enumerates on a client of
+// its own, made on the worker by make_enumerator. Without a factory it uses
+// the app's client, which must then be thread safe like the mock.
+class AudioDeviceRegistry {
+public:
+    using ClientFactory = std::function<std::unique_ptr<AfvClient>()>;
+
+    explicit AudioDeviceRegistry(
+        AfvClient* client, ClientFactory make_enumerator = nullptr);
+    ~AudioDeviceRegistry();
+
+    AudioDeviceRegistry(const AudioDeviceRegistry&) = delete;
+    AudioDeviceRegistry& operator=(const AudioDeviceRegistry&) = delete;
+
+    // Asks for the devices of the given audio API to be enumerated again
+    void refresh(const std::string& api_name);
+
+    // Publishes the latest enumeration to the shared device lists, must be
+    // called from the UI thread. Returns true if the lists changed.
+    bool update();
+
+private:
+    // The timer refresh is skipped while the audio is running, devices
+    // cannot be changed then anyway
+    static constexpr auto kRefreshInterval = 10s;
+
+    struct Devices {
+        std::map<unsigned int, std::string> apis;
+        unsigned int api = -1;
+        std::vector<std::string> inputs;
+        std::vector<std::string> outputs;
+    };
+
+    // Only touched from the UI thread
+    AfvClient* client_;
+    ClientFactory make_enumerator_;
+
+    std::thread worker_;
+    std::condition_variable cv_;
+    std::mutex m_;
+    bool keep_running_ = true;
+    bool refresh_requested_ = true;
+    std::string api_name_;
+
+    // Sampled from the client in update(), for the worker's timer
+    std::atomic<bool> audio_running_ = false;
+
+    // Guarded by m_, handed over by update()
+    Devices latest_;
+    bool has_update_ = false;
+    bool api_requested_ = false;
+
+    static Devices enumerate(AfvClient& client, const std::string& api_name);
+
+    void worker();
+};
+}
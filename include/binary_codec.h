@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Little helpers for the compact binary files we write: unsigned varints and
+// length prefixed strings
+namespace vector_audio::codec {
+
+inline void putVarint(std::string& out, std::uint64_t value)
+{
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+inline void putString(std::string& out, std::string_view value)
+{
+    putVarint(out, value.size());
+    out.append(value);
+}
+
+// The readers consume what they read from the front of the view, and return
+// false if it ends too early
+inline bool getVarint(std::string_view& in, std::uint64_t& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64 && !in.empty(); shift += 7) {
+        auto byte = static_cast<std::uint8_t>(in.front());
+        in.remove_prefix(1);
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline bool getString(std::string_view& in, std::string& value)
+{
+    std::uint64_t size = 0;
+    if (!getVarint(in, size) || size > in.size()) {
+        return false;
+    }
+    value.assign(in.substr(0, size));
+    in.remove_prefix(size);
+    return true;
+}
+
+}
@@ -1,13 +1,18 @@
 #pragma once
 #include "platform_folders.h"
 #include "spdlog/async.h"
+#include "spdlog/pattern_formatter.h"
 #include "spdlog/sinks/basic_file_sink.h"
 #include "spdlog/sinks/rotating_file_sink.h"
 #include "spdlog/sinks/stdout_color_sinks.h"
 #include "spdlog/spdlog.h"
 #include <SFML/Config.hpp>
+#include <chrono>
+#include <condition_variable>
 #include <filesystem>
 #include <iostream>
+#include <memory>
+#include <optional>
 #include <string>
 #include <thread>
 #include <toml.hpp>
@@ -15,6 +20,12 @@
 
 namespace vector_audio {
 
+#ifdef NDEBUG
+constexpr const char* kDefaultLogLevel = "info";
+#else
+constexpr const char* kDefaultLogLevel = "trace";
+#endif
+
 class Configuration {
 public:
     static toml::value config_;
@@ -22,18 +33,73 @@ public:
     static inline std::string config_file_name_ = "config.toml";
     static inline std::string airports_db_file_path_ = "airports.json";
 
+    // Parses the config file and loads every setting, see load_settings()
     static void build_config();
 
+    // Loads every known setting from the parsed config in a single pass, any
+    // missing or invalid setting is set to its default
+    static void load_settings();
+
+    // Stores the current settings back, and queues a write only if something
+    // changed. Returns whether anything changed.
+    static bool save_settings();
+
+    // Stores a single setting back, leaving any other change unsaved, for
+    // values that are written on their own rather than from Settings
+    static bool save_setting(const std::string& section, const std::string& key);
+
     static std::filesystem::path get_resource_folder();
 
     static std::string get_linux_config_folder();
+    // Named instances get their own subfolder, so they keep a separate config
+    // and log file
     static std::filesystem::path get_config_folder_path();
 
+    // Selects a named instance profile, must be called before anything uses
+    // the config folder. Names are limited to letters, digits, - and _ as
+    // they end up in paths and lock names.
+    static bool set_instance_name(const std::string& name);
+    static const std::string& get_instance_name();
+
     inline static std::mutex config_writer_lock_;
 
     static void build_logger();
 
+    // Applies the log levels and sinks from the config, the logger is built
+    // before the config is loaded
+    static void apply_log_settings();
+
+    // Applies just the levels, they can be changed while running
+    static void apply_log_levels();
+
+    // Queues the current config to be written, bursts of calls are coalesced
+    // into a single write by the writer thread. It writes once nothing new
+    // came in for kConfigWriteDelay, and at the latest kConfigWriteMaxDelay
+    // after the first pending change, so a steady stream still gets saved.
     static void write_config_async();
+
+    static constexpr auto kConfigWriteDelay = std::chrono::milliseconds(250);
+    static constexpr auto kConfigWriteMaxDelay = std::chrono::seconds(1);
+
+    // Writes any pending change and stops the writer thread
+    static void stop_config_writer();
+
+    // How many times the config file was written since the start
+    static unsigned int config_file_writes();
+
+private:
+    inline static std::string instance_name_;
+
+    inline static std::unique_ptr<std::thread> config_writer_thread_;
+    inline static std::condition_variable config_writer_cv_;
+    inline static std::optional<toml::value> pending_config_;
+    inline static unsigned int pending_generation_ = 0;
+    inline static unsigned int config_file_writes_ = 0;
+    inline static bool config_writer_running_ = false;
+
+    static void config_writer();
+
+    static void write_config_file(const toml::value& config);
 };
 
 }
\ No newline at end of file
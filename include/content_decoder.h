@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <zlib.h>
+
+namespace vector_audio::vatsim {
+
+// Inflates a gzip or deflate encoded response body chunk by chunk, so the
+// decoded data can be handed on as it arrives. Any other encoding is passed
+// through as is.
+class ContentDecoder {
+public:
+    using Sink = std::function<bool(const char*, std::size_t)>;
+
+    // The encodings we ask for, in the Accept-Encoding header format
+    static constexpr const char* kAcceptEncoding = "gzip, deflate";
+
+    explicit ContentDecoder(const std::string& encoding);
+    ~ContentDecoder();
+
+    ContentDecoder(const ContentDecoder&) = delete;
+    ContentDecoder& operator=(const ContentDecoder&) = delete;
+
+    // Returns false if the data is corrupt or the sink stopped
+    bool decode(const char* data, std::size_t size, const Sink& sink);
+
+    // False if a compressed body ended before the end of its stream
+    bool finished() const { return !compressed_ || done_; }
+
+private:
+    bool compressed_ = false;
+    bool done_ = false;
+    z_stream stream_ {};
+};
+
+}
@@ -1,82 +1,272 @@
 #pragma once
 #include <atomic>
+#include <charconv>
 #include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <exception>
+#include <functional>
+#include <future>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <nlohmann/json.hpp>
+#include <optional>
 #include <nlohmann/json_fwd.hpp>
-#include <regex>
 #include <spdlog/spdlog.h>
 #include <string>
+#include <string_view>
 #include <thread>
 
-#include <random>
+#include <algorithm>
 #include <utility>
+#include <vector>
 
+#include "content_decoder.h"
+#include "datafile_diff.h"
+#include "datafile_stream.h"
+#include "event_loop.h"
 #include "shared.h"
+#include "stop_token.h"
 #include "util.h"
+#include "vatsim_parsers.h"
 #include <httplib.h>
 
 namespace vector_audio::vatsim {
 using namespace std::chrono_literals;
 
+// Where VATSIM is reached, and how often. The defaults are the live network,
+// the tests point them at local servers.
+struct Endpoints {
+    std::string status_server = vatsim_status_host;
+    std::string status_path = vatsim_status_url;
+    std::string slurper_server = slurper_host;
+    std::string slurper_path = slurper_url;
+    // Whether the probed endpoints are kept in the config folder
+    bool use_cache = true;
+    std::chrono::milliseconds poll_interval = 15s;
+};
+
 class DataHandler {
 public:
-    DataHandler();
-    virtual ~DataHandler()
-    {
-        {
-            std::unique_lock<std::mutex> lk(m_);
-            keep_running_ = false;
-        }
-        cv_.notify_one();
-
-        if (workerThread_->joinable())
-            workerThread_->join();
-    };
+    // Polls VATSIM on the loop until destroyed, unless in offline mode
+    explicit DataHandler(EventLoop& loop, Endpoints endpoints = {});
+    virtual ~DataHandler();
 
     bool isSlurperAvailable() const { return this->slurperAvailable_; }
 
     bool isDatafileAvailable() const { return this->dataFileAvailable_; }
 
-    bool getConnectionStatusWithSlurper();
-
-    bool getConnectionStatusWithDatafile();
+    // Checks our session right away and blocks until it is known, for the
+    // Connect button. Returns whether we are connected to VATSIM.
+    bool checkSessionNow();
 
     bool getPilotPositionWithAnything(
         const std::string& callsign, double& latitude, double& longitude);
 
+    using PilotPositionHandler
+        = std::function<void(bool found, double latitude, double longitude)>;
+
+    // Looks a pilot up without blocking the caller, the handler runs on the
+    // network loop. Several lookups can be outstanding at once.
+    void findPilotPosition(std::string callsign, PilotPositionHandler done);
+
+    // Bytes received from the network, and what they decoded to
+    struct TransferStats {
+        std::uint64_t wire_bytes = 0;
+        std::uint64_t decoded_bytes = 0;
+    };
+
+    static TransferStats transferStats();
+
+    // How long session checks take to reach an answer, over the last
+    // kSessionSamples checks, and how often the datafile was raced against a
+    // slow slurper
+    struct SessionCheckStats {
+        std::chrono::milliseconds p50 = 0ms;
+        std::chrono::milliseconds p99 = 0ms;
+        std::uint64_t checks = 0;
+        std::uint64_t hedged = 0;
+        std::uint64_t datafile_won = 0;
+    };
+
+    SessionCheckStats sessionCheckStats();
+
+    using ChangeHandler
+        = std::function<void(const std::vector<DatafileChange>&)>;
+
+    // Changes between consecutive datafile polls. The first poll after the
+    // first subscription reports everything as added, later subscribers only
+    // see changes from then on. While nobody is subscribed the datafile is
+    // only read up to our own entry. Handlers run on the network loop, and
+    // once unsubscribeFromChanges returns a handler is no longer running.
+    int subscribeToChanges(ChangeHandler handler);
+    void unsubscribeFromChanges(int id);
+
+    // Feeds a recorded response back in place of the network, there is no
+    // polling during a replay
+    void replayResponse(
+        const std::string& url, int status, const std::string& body);
+
 private:
-    std::regex regex_;
-    std::unique_ptr<std::thread> workerThread_;
-    std::atomic<bool> keep_running_ = true;
-    std::condition_variable cv_;
-    std::mutex m_;
+    // The datafile is raced against the slurper once the slurper takes
+    // longer than its own p95. Until there are enough samples for that, the
+    // default applies. The bounds keep a few fast or slow answers from
+    // hedging every check or none.
+    static constexpr std::size_t kSessionSamples = 200;
+    static constexpr std::size_t kMinHedgeSamples = 10;
+    static constexpr auto kDefaultHedgeDelay = 1000ms;
+    static constexpr auto kMinHedgeDelay = 200ms;
+    static constexpr auto kMaxHedgeDelay = 5000ms;
+
+    // Longer than a check that runs into the client timeouts, so only a check
+    // the loop never ran gets cut short
+    static constexpr auto kSessionCheckTimeout = 20s;
 
-    std::string datafile_host_;
-    std::string datafile_url_;
+    EventLoop& loop_;
+    const Endpoints endpoints_;
+    // The coroutines run on the strand, and only leave it for the blocking
+    // calls they hand to the loop
+    restinio::asio_ns::strand<restinio::asio_ns::io_context::executor_type>
+        strand_;
+    restinio::asio_ns::steady_timer poll_timer_;
+    StopSource stop_;
 
-    bool slurperAvailable_ = false;
-    bool dataFileAvailable_ = false;
+    // Coroutines still running, the destructor waits for them to end
+    int tasks_ = 0;
+    std::condition_variable tasks_cv_;
+    std::mutex tasks_m_;
+
+    struct DatafileMirror {
+        std::string host;
+        std::string url;
+        std::chrono::milliseconds latency = 0ms;
+        bool healthy = false;
+    };
+
+    std::map<int, ChangeHandler> change_handlers_;
+    int next_change_handler_ = 0;
+    // The last complete datafile, it is only kept while someone is subscribed
+    std::optional<DatafileSnapshot> snapshot_;
+    std::mutex change_handlers_m_;
+
+    // All the v3 datafile mirrors from the status file, ranked by latency
+    std::vector<DatafileMirror> datafile_mirrors_;
+    std::mutex mirrors_m_;
+
+    std::atomic<bool> slurperAvailable_ = false;
+    std::atomic<bool> dataFileAvailable_ = false;
     bool had_one_disconnect_ = false;
-    bool yx_ = false;
+    std::atomic<bool> yx_ = false;
+
+    // What a session check found out about our connection, applied once the
+    // check that answered first is known
+    struct SessionInfo {
+        std::string callsign;
+        int frequency = 0;
+        int facility = 0;
+        double latitude = 0.0;
+        double longitude = 0.0;
+    };
+
+    enum class SessionSource { Slurper, Datafile };
+
+    // A slurper check and possibly a datafile check racing each other. Only
+    // touched on the strand, the waiting check sleeps on wake until the first
+    // answer comes in.
+    struct SessionRace {
+        explicit SessionRace(
+            const restinio::asio_ns::strand<
+                restinio::asio_ns::io_context::executor_type>& strand)
+            : wake(strand)
+        {
+        }
+
+        restinio::asio_ns::steady_timer wake;
+        bool answered = false;
+        SessionSource winner = SessionSource::Slurper;
+        std::optional<bool> connected;
+        SessionInfo info;
+    };
 
-    static std::string downloadString(httplib::Client& cli, std::string url);
+    std::deque<std::chrono::milliseconds> slurper_latencies_;
+    std::deque<std::chrono::milliseconds> detection_latencies_;
+    SessionCheckStats session_stats_;
+    std::mutex session_stats_m_;
 
-    bool parseSlurper(const std::string& sluper_data);
+    inline static std::atomic<std::uint64_t> wire_bytes_ = 0;
+    inline static std::atomic<std::uint64_t> decoded_bytes_ = 0;
+
+    // Downloads a URL, asking for a compressed body, and hands the decoded
+    // body to the receiver as it arrives. Returns the HTTP status, or 0 if
+    // there was no usable response or shutdown aborted it.
+    int fetch(const std::string& host, const std::string& url,
+        const ContentDecoder::Sink& receiver);
+
+    std::string downloadString(const std::string& host, std::string url);
+    std::string downloadString(
+        const std::string& host, std::string url, int& status);
+
+    bool parseSlurper(std::string_view sluper_data, SessionInfo& session);
+
+    // Element handler for the controllers array of the datafile, it returns
+    // true once it found our entry
+    static bool matchController(const nlohmann::json& controller,
+        bool& connected, SessionInfo& session);
 
     bool getLatestDatafileURL();
 
+    // The two ways to check our session, they block and only fill in session
+    // when we are connected. Nothing is returned when the check got no usable
+    // answer, which says nothing about the session.
+    std::optional<bool> getConnectionStatusWithSlurper(SessionInfo& session);
+    std::optional<bool> getConnectionStatusWithDatafile(SessionInfo& session);
+
     bool getPilotPositionWithSlurper(
         const std::string& callsign, double& latitude, double& longitude);
 
     bool getPilotPositionWithDatafile(
         const std::string& callsign, double& latitude, double& longitude);
 
+    void probeMirror(DatafileMirror& mirror);
+
     bool checkIfdatafileAvailable();
 
-    static bool checkIfSlurperAvailable();
+    enum class StreamResult { Failed, NotFound, Found };
+
+    StreamResult streamFromMirror(const DatafileMirror& mirror,
+        const std::vector<std::string>& arrays,
+        const DatafileSax::ElementHandler& handler, bool record);
+
+    // Streams the datafile through the handler, failing over between mirrors.
+    // Anything the handler collected should be dropped in reset, which runs
+    // before each mirror is tried. Replay takes every recorded datafile as a
+    // session check, so only those set record.
+    StreamResult streamDatafile(const std::vector<std::string>& arrays,
+        const DatafileSax::ElementHandler& handler,
+        const std::function<void()>& reset = nullptr, bool record = false);
+
+    bool hasChangeHandlers();
+
+    // Checks our own session against the controllers of the datafile, and
+    // fills the snapshot with everyone on the way if there is one
+    static DatafileSax::ElementHandler sessionHandler(
+        std::optional<DatafileSnapshot>& snapshot, bool& found,
+        bool& connected, SessionInfo& session);
+
+    // Takes the place of the last snapshot and tells subscribers what changed
+    void publishChanges(DatafileSnapshot snapshot);
+
+    // For subscribers while the session comes from the slurper
+    void pollDatafileChanges();
+
+    bool checkIfSlurperAvailable();
+
+    // The endpoints as last probed are kept in the config folder, so a start
+    // can use them right away and probe again in the background
+    bool loadEndpointCache();
+    void saveEndpointCache();
 
     void getAvailableEndpoints();
 
@@ -84,13 +274,38 @@ private:
 
     void handleDisconnect();
 
-    static bool parseDatafile(const std::string& data);
+    bool parseDatafile(const std::string& data);
 
-    static void updateSessionInfo(std::string callsign, int frequency = 0,
-        int facility = 0, double latitude = 0.0, double longitude = 0.0);
+    // Session checks can run side by side, so the session is only read and
+    // written under its lock
+    static bool sessionCallsignChanged(std::string_view callsign);
+    static void updateSessionInfo(const SessionInfo& session);
 
     static void handleConnect();
 
-    void worker();
+    // Runs a coroutine on the strand, counted until it ends
+    void spawn(restinio::asio_ns::awaitable<void> task);
+
+    // The endpoints are found from the cache or by probing before the first
+    // poll, then the session is checked every poll_interval until shutdown
+    restinio::asio_ns::awaitable<void> pollLoop();
+
+    // Checks the session with the slurper, racing the datafile against it
+    // when it is slow, and applies what the first answer found. Returns
+    // whether we are connected, nothing if the check got no answer, and
+    // whether the datafile was already read.
+    restinio::asio_ns::awaitable<std::optional<bool>> checkSession(
+        bool& read_datafile);
+    restinio::asio_ns::awaitable<void> runSessionCheck(
+        std::shared_ptr<SessionRace> race, SessionSource source);
+    restinio::asio_ns::awaitable<void> answerSessionCheck(
+        std::promise<bool> result);
+
+    std::chrono::milliseconds hedgeDelay();
+    void recordSessionCheck(std::chrono::milliseconds latency, bool hedged,
+        SessionSource winner);
+
+    restinio::asio_ns::awaitable<void> lookupPilot(
+        std::string callsign, PilotPositionHandler done);
 };
 }
\ No newline at end of file
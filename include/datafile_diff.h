@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace vector_audio::vatsim {
+
+// The part of a datafile entry kept between polls
+struct NetworkEntry {
+    int cid = 0;
+    std::string callsign;
+    bool is_controller = false;
+    // Controllers only, in Hz
+    int frequency = 0;
+    // Pilots only
+    double latitude = 0.0;
+    double longitude = 0.0;
+};
+
+enum class ChangeType { Added, Removed, Moved, FrequencyChanged };
+
+const char* changeTypeName(ChangeType type);
+
+struct DatafileChange {
+    ChangeType type = ChangeType::Added;
+    // The new state, or the last known one for a removal
+    NetworkEntry entry;
+    int previous_frequency = 0;
+};
+
+// The controllers and pilots of one datafile, keyed by callsign
+class DatafileSnapshot {
+public:
+    // Takes an element of the controllers or pilots array, anything else or
+    // an element without a callsign is ignored
+    void add(const std::string& array, const nlohmann::json& element);
+
+    std::size_t size() const { return entries_.size(); }
+
+    // What changed since an older snapshot, in no particular order. A callsign
+    // that switched between pilot and controller is removed and added again.
+    std::vector<DatafileChange> diff(const DatafileSnapshot& before) const;
+
+private:
+    std::unordered_map<std::string, NetworkEntry> entries_;
+};
+
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace vector_audio::vatsim {
+
+// Hands the chunks of a download over to a parser running on another thread.
+// The writer blocks once max_buffered bytes are waiting, so memory use does
+// not depend on the size of the download.
+class ChunkPipe : public std::streambuf {
+public:
+    explicit ChunkPipe(std::size_t max_buffered);
+
+    // Returns false once the reader has stopped, nothing more is needed then
+    bool write(const char* data, std::size_t size);
+    // No more data, the reader sees the end of the stream
+    void close();
+    // Called by the reader when it is done, unblocks the writer
+    void stop();
+
+protected:
+    int_type underflow() override;
+
+private:
+    std::mutex m_;
+    std::condition_variable cv_;
+    std::deque<std::string> chunks_;
+    std::size_t buffered_ = 0;
+    std::size_t max_buffered_;
+    bool closed_ = false;
+    bool stopped_ = false;
+
+    // The chunk being read, only touched by the reader
+    std::string current_;
+};
+
+// SAX handler that only builds the elements of the given top level arrays of
+// the datafile, one at a time. Each element is handed to the callback along
+// with the name of its array, and the callback returns true to stop the parse
+// once it found what it was looking for. An element the callback throws a json
+// error on is skipped.
+class DatafileSax : public nlohmann::json_sax<nlohmann::json> {
+public:
+    using ElementHandler
+        = std::function<bool(const std::string&, const nlohmann::json&)>;
+
+    DatafileSax(std::vector<std::string> arrays, ElementHandler handler);
+
+    bool null() override;
+    bool boolean(bool val) override;
+    bool number_integer(number_integer_t val) override;
+    bool number_unsigned(number_unsigned_t val) override;
+    bool number_float(number_float_t val, const string_t& s) override;
+    bool string(string_t& val) override;
+    bool binary(binary_t& val) override;
+    bool start_object(std::size_t elements) override;
+    bool key(string_t& val) override;
+    bool end_object() override;
+    bool start_array(std::size_t elements) override;
+    bool end_array() override;
+    bool parse_error(std::size_t position, const std::string& last_token,
+        const nlohmann::detail::exception& ex) override;
+
+    // The handler stopped the parse
+    bool found() const { return found_; }
+    bool failed() const { return failed_; }
+
+private:
+    bool building() const { return !stack_.empty(); }
+    nlohmann::json* insert(nlohmann::json&& value);
+    bool value(nlohmann::json&& value);
+
+    std::vector<std::string> arrays_;
+    ElementHandler handler_;
+
+    std::size_t depth_ = 0;
+    // While in_array_ is set, this is the name of the array
+    std::string top_key_;
+    bool in_array_ = false;
+
+    // The element being built, and the containers open inside it
+    nlohmann::json element_;
+    std::vector<nlohmann::json*> stack_;
+    std::string key_;
+
+    bool found_ = false;
+    bool failed_ = false;
+};
+
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <restinio/asio_include.hpp>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace vector_audio {
+
+// The one asio io_context all the networking runs on: the SDK server and the
+// VATSIM polling coroutines. A couple of threads are enough, as nothing on
+// them blocks. httplib requests do block, so coroutines hand them to a
+// separate pool with runBlocking().
+class EventLoop {
+public:
+    EventLoop(std::size_t threads, std::size_t blocking_threads);
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    restinio::asio_ns::io_context& context() { return context_; }
+
+    std::size_t threadCount() const { return threads_.size(); }
+
+    // Runs fn on the blocking pool, the coroutine resumes on its own executor
+    // with the result, or the exception fn threw
+    template <typename F>
+    restinio::asio_ns::awaitable<std::invoke_result_t<F>> runBlocking(F fn)
+    {
+        using Result = std::invoke_result_t<F>;
+        co_return co_await restinio::asio_ns::co_spawn(
+            blocking_,
+            [fn = std::move(fn)]() -> restinio::asio_ns::awaitable<Result> {
+                co_return fn();
+            },
+            restinio::asio_ns::use_awaitable);
+    }
+
+private:
+    restinio::asio_ns::io_context context_;
+    // Keeps run() going while nothing is queued
+    restinio::asio_ns::executor_work_guard<
+        restinio::asio_ns::io_context::executor_type>
+        work_;
+    std::vector<std::thread> threads_;
+    restinio::asio_ns::thread_pool blocking_;
+};
+
+}
@@ -0,0 +1,12 @@
+#pragma once
+#include <string>
+
+namespace vector_audio {
+
+// Runs VectorAudio without a window or ImGui, for recording and monitoring
+// boxes. The afv client follows the VATSIM session on its own and the SDK
+// server keeps answering. Returns once SIGINT or SIGTERM is received, or once
+// the replay log is exhausted when one is given.
+int run_headless(const std::string& replay_path = "");
+
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include "afv_client.h"
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace vector_audio {
+
+// In process stand-in for the afv client, to benchmark and replay the app
+// without the audio and network stack. It connects instantly, serves a set of
+// generated stations and simulates traffic on a virtual clock, so the same
+// options always give the same run.
+class MockAfvClient : public AfvClient {
+public:
+    struct Options {
+        // Stations returned for any VCCS request
+        int stations = 10;
+        // Share of the time each received frequency carries traffic, 0 to 1
+        double rx_activity = 0.2;
+        // How long a simulated transmission lasts
+        std::chrono::milliseconds transmission_length { 4000 };
+        // Added to every call, to mimic a slow client
+        std::chrono::microseconds call_latency { 0 };
+        std::uint32_t seed = 1;
+    };
+
+    explicit MockAfvClient(Options options);
+
+    // Moves the virtual clock forward, the traffic pattern follows it
+    void advance(std::chrono::microseconds step);
+
+    void SetCredentials(std::string username, std::string password) override;
+    void SetCallsign(std::string callsign) override;
+    void SetClientPosition(
+        double lat, double lon, double amslm, double aglm) override;
+    bool IsVoiceConnected() override;
+    bool IsAPIConnected() override;
+    bool Connect() override;
+    void Disconnect() override;
+    void SetAudioApi(unsigned int api) override;
+    std::map<unsigned int, std::string> GetAudioApis() override;
+    void SetAudioInputDevice(std::string inputDevice) override;
+    std::vector<std::string> GetAudioInputDevices(
+        unsigned int mAudioApi) override;
+    void SetAudioOutputDevice(std::string outputDevice) override;
+    void SetAudioSpeakersOutputDevice(std::string outputDevice) override;
+    void SetHeadsetOutputChannel(int channel) override;
+    std::vector<std::string> GetAudioOutputDevices(
+        unsigned int mAudioApi) override;
+    double GetInputPeak() override;
+    double GetInputVu() override;
+    void SetEnableInputFilters(bool enableInputFilters) override;
+    void SetEnableOutputEffects(bool enableEffects) override;
+    void StartAudio() override;
+    void StopAudio() override;
+    bool IsAudioRunning() override;
+    void SetTx(unsigned int freq, bool active) override;
+    void SetRx(unsigned int freq, bool active) override;
+    void SetXc(unsigned int freq, bool active) override;
+    void SetOnHeadset(unsigned int freq, bool active) override;
+    bool GetTxActive(unsigned int freq) override;
+    bool GetRxActive(unsigned int freq) override;
+    bool GetOnHeadset(unsigned int freq) override;
+    bool GetTxState(unsigned int freq) override;
+    bool GetRxState(unsigned int freq) override;
+    bool GetXcState(unsigned int freq) override;
+    void UseTransceiversFromStation(std::string station, int freq) override;
+    void FetchTransceiverInfo(std::string station) override;
+    void FetchStationVccs(std::string station) override;
+    void GetStation(std::string station) override;
+    int GetTransceiverCountForStation(std::string station) override;
+    void SetPtt(bool pttState) override;
+    void StopAtisPlayback() override;
+    bool IsAtisPlayingBack() override;
+    std::string LastTransmitOnFreq(unsigned int freq) override;
+    void SetRadiosGain(float gain) override;
+    void AddFrequency(unsigned int freq, std::string stationName) override;
+    void RemoveFrequency(unsigned int freq) override;
+    bool IsFrequencyActive(unsigned int freq) override;
+    void SetHardware(afv_native::HardwareType hardware) override;
+    void RaiseClientEvent(ClientEventCallback callback) override;
+
+private:
+    struct Frequency {
+        std::string station;
+        bool rx = false;
+        bool tx = false;
+        bool xc = false;
+        bool on_headset = true;
+    };
+
+    void simulateLatency() const;
+    void raise(afv_native::ClientEventType evt, void* data = nullptr,
+        void* data2 = nullptr);
+
+    std::uint32_t hash(std::uint32_t value, std::int64_t window) const;
+    // The pilot transmitting on a frequency during a traffic window, if any
+    std::string transmitterIn(unsigned int freq, std::int64_t window) const;
+    std::int64_t currentWindow() const;
+
+    Options options_;
+
+    // Guards the state below, the SDK server reads it from its own threads.
+    // It is never held while raising an event, as handlers call back in.
+    mutable std::mutex m_;
+    std::chrono::microseconds now_ { 0 };
+    bool api_connected_ = false;
+    bool voice_connected_ = false;
+    bool audio_running_ = false;
+    bool ptt_ = false;
+    std::map<unsigned int, Frequency> frequencies_;
+
+    ClientEventCallback callback_;
+};
+
+}
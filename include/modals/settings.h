@@ -1,5 +1,6 @@
 #pragma once
-#include "afv-native/atcClientWrapper.h"
+#include "afv_client.h"
+#include "audio_device_registry.h"
 #include "config.h"
 #include "imgui.h"
 #include "imgui_internal.h"
@@ -15,6 +16,7 @@
 namespace vector_audio::modals {
 class Settings {
 public:
-    static void render(afv_native::api::atcClient* mClient);
+    static void render(AfvClient* mClient,
+        AudioDeviceRegistry* audioDevices);
 };
 }
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <map>
+#include <string>
+
+namespace vector_audio {
+
+// Frame profiler shown as an overlay, toggled with Ctrl+Shift+P. It must only
+// be used from the UI thread. Timers only record while the overlay is open,
+// so they cost next to nothing otherwise.
+class Profiler {
+public:
+    using clock = std::chrono::steady_clock;
+
+    // Times a phase until end() is called or the scope exits. The name must
+    // outlive the profiler, string literals are expected. Phases are told
+    // apart by the pointer, so time each one from a single place.
+    class Scope {
+    public:
+        explicit Scope(const char* name);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        void end();
+
+    private:
+        const char* name_;
+        clock::time_point start_;
+        bool running_;
+    };
+
+    static void toggle();
+    static bool is_enabled();
+
+    static void begin_frame();
+    static void end_frame();
+
+    static void draw();
+
+    // Writes the recorded events in the Chrome trace event format, which can
+    // be opened in chrome://tracing or Perfetto
+    static bool export_chrome_trace(const std::filesystem::path& path);
+
+private:
+    static constexpr size_t kHistorySize = 240;
+    static constexpr size_t kMaxEvents = 50000;
+    static constexpr const char* kFrameEvent = "frame";
+
+    struct Event {
+        const char* name;
+        std::int64_t start_us;
+        std::int64_t duration_us;
+    };
+
+    static void record(const char* name, clock::time_point start,
+        clock::time_point end);
+
+    inline static bool enabled_ = false;
+    inline static clock::time_point epoch_ = clock::now();
+    inline static clock::time_point frame_start_;
+
+    // Rolling history, in milliseconds, indexed by history_index_
+    inline static size_t history_index_ = 0;
+    inline static std::array<float, kHistorySize> frame_times_ {};
+    // Keyed by the literal itself, so recording a phase never builds a string.
+    // The rows keep a fixed order for the run.
+    inline static std::map<const char*, std::array<float, kHistorySize>>
+        phase_times_;
+
+    inline static std::deque<Event> events_;
+    inline static std::string last_export_message_;
+};
+
+}
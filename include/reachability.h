@@ -0,0 +1,19 @@
+#pragma once
+#include "stop_token.h"
+#include <chrono>
+#include <string>
+
+namespace vector_audio {
+
+// Opens and drops a plain TCP connection to the host of a URL such as
+// "https://example.org" or "http://127.0.0.1:8080". httplib cannot abort a
+// name lookup or a connect in progress, Client::stop() even waits for one to
+// finish, so requests check the host with this first.
+//
+// The lookup and connect run on a thread of their own, bounded by timeout.
+// Once the token is stopped this returns false right away, and the check
+// winds down on its own.
+bool waitUntilReachable(const std::string& host,
+    std::chrono::milliseconds timeout, const StopToken& token);
+
+}
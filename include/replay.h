@@ -0,0 +1,140 @@
+#pragma once
+#include "afv-native/event.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace vector_audio::application {
+class AppCore;
+}
+
+namespace vector_audio::replay {
+
+// What a record in a replay log holds
+enum class RecordKind : std::uint8_t {
+    ClientEvent = 1, // code is the ClientEventType
+    HttpResponse = 2, // code is the HTTP status, detail the URL
+    PttChange = 3, // code is 1 when the PTT opened
+};
+
+struct Record {
+    RecordKind kind = RecordKind::ClientEvent;
+    // Time since the recording started
+    std::chrono::microseconds timestamp { 0 };
+    std::uint32_t code = 0;
+    std::string detail;
+    std::string payload;
+};
+
+// Records the afv client events, DataHandler HTTP responses and PTT changes
+// to a compact binary log. Every record is a kind byte followed by varints
+// for the time since the previous record and the code, then two length
+// prefixed strings. Recording can be fed from any thread.
+//
+// The session checks make up most of a log. A slurper answer is a few hundred
+// bytes. A check on the datafile records the elements its parse read as JSON,
+// which is the controllers up to ours: some 100 KB of a datafile of several
+// MB, so about 25 MB an hour at one check per 15 s poll. With SDK change
+// subscribers the pilots are read too, and a check costs close to the whole
+// datafile, about 1 GB an hour.
+class Recorder {
+public:
+    static bool start(const std::filesystem::path& path);
+    static void stop();
+
+    static bool is_recording() { return recording_; }
+
+    static void record_client_event(
+        afv_native::ClientEventType evt, void* data, void* data2);
+    static void record_http_response(
+        const std::string& url, int status, const std::string& body);
+    static void record_ptt(bool open);
+
+private:
+    static void write(RecordKind kind, std::uint32_t code,
+        std::string_view detail, std::string_view payload);
+
+    inline static std::atomic<bool> recording_ = false;
+    inline static std::mutex m_;
+    inline static std::ofstream out_;
+    inline static std::chrono::steady_clock::time_point start_;
+    inline static std::chrono::microseconds last_timestamp_ { 0 };
+};
+
+// Reads back a log written by the Recorder
+class LogReader {
+public:
+    explicit LogReader(const std::filesystem::path& path);
+
+    bool is_valid() const { return valid_; }
+
+    // Returns false at the end of the log, or if it is truncated
+    bool next(Record& record);
+
+private:
+    bool read_varint(std::uint64_t& value);
+    bool read_string(std::string& value);
+
+    std::ifstream in_;
+    bool valid_ = false;
+    std::chrono::microseconds timestamp_ { 0 };
+};
+
+// Rebuilds the pointers an afv client event carries from a recorded payload,
+// they stay valid as long as the event
+class ReplayEvent {
+public:
+    bool decode(const Record& record);
+
+    afv_native::ClientEventType type() const { return type_; }
+    void* data() { return data_; }
+    void* data2() { return data2_; }
+
+private:
+    afv_native::ClientEventType type_
+        = afv_native::ClientEventType::APIServerConnected;
+    void* data_ = nullptr;
+    void* data2_ = nullptr;
+
+    std::string string_;
+    int int_ = 0;
+    unsigned int unsigned_ = 0;
+    bool flag_ = false;
+    afv_native::afv::APISessionError api_error_
+        = afv_native::afv::APISessionError::NoError;
+    std::map<std::string, unsigned int> stations_;
+    std::pair<std::string, unsigned int> station_;
+};
+
+// Feeds a recorded log back into the core on a virtual clock, so a replay
+// runs the same way every time regardless of how long frames take
+class ReplayDriver {
+public:
+    ReplayDriver(
+        const std::filesystem::path& path, application::AppCore& core);
+
+    bool is_valid() const { return reader_.is_valid(); }
+
+    // Moves the clock forward by one step and dispatches every record that is
+    // due, returns false once the log is exhausted
+    bool advance(std::chrono::microseconds step);
+
+private:
+    void dispatch(const Record& record);
+
+    LogReader reader_;
+    application::AppCore& core_;
+    std::chrono::microseconds now_ { 0 };
+    std::optional<Record> pending_;
+    bool done_ = false;
+};
+
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include "event_loop.h"
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+
+#if defined(ASIO_HAS_LOCAL_SOCKETS) || defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+#define VECTOR_HAS_SDK_SOCKET 1
+#endif
+
+namespace vector_audio {
+
+// Serves the SDK routes over a Unix domain socket, for plugins and overlays on
+// the same machine. Only as much HTTP/1.1 as the SDK needs is spoken: GET
+// requests without a body, with keep-alive. The socket file is only
+// accessible to the user running VectorAudio.
+class SDKSocketServer {
+public:
+    // Returns the body for a request target, like the TCP server
+    using Handler = std::function<std::string(bool, std::string_view)>;
+
+    SDKSocketServer(
+        EventLoop& loop, std::filesystem::path path, Handler handler);
+    ~SDKSocketServer();
+
+    SDKSocketServer(const SDKSocketServer&) = delete;
+    SDKSocketServer& operator=(const SDKSocketServer&) = delete;
+
+private:
+#ifdef VECTOR_HAS_SDK_SOCKET
+    using Socket = restinio::asio_ns::local::stream_protocol::socket;
+
+    restinio::asio_ns::awaitable<void> accept();
+    restinio::asio_ns::awaitable<void> serve(std::shared_ptr<Socket> socket);
+
+    // Runs a coroutine on the strand, counted until it ends
+    void spawn(restinio::asio_ns::awaitable<void> task);
+
+    // The acceptor and the open connections are only touched on the strand
+    restinio::asio_ns::strand<restinio::asio_ns::io_context::executor_type>
+        strand_;
+    restinio::asio_ns::local::stream_protocol::acceptor acceptor_;
+    std::set<std::shared_ptr<Socket>> connections_;
+    bool listening_ = false;
+
+    // Coroutines still running, the destructor waits for them to end
+    int tasks_ = 0;
+    std::condition_variable tasks_cv_;
+    std::mutex tasks_m_;
+#endif
+
+    std::filesystem::path path_;
+    Handler handler_;
+};
+
+}
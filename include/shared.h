@@ -14,9 +14,6 @@
 #define slurper_host "https://slurper.vatsim.net"
 #define slurper_url "/users/info/?cid="
 
-#define url_regex                                                              \
-    "^(https?:\\/\\/)?(?:[^@\n]+@)?(?:www\\.)?([^:\\/\n?]+)(\\/[.A-z0-9/-]+)$"
-
 namespace vector_audio::shared {
 struct StationElement {
     int freq;
@@ -66,6 +63,10 @@ inline int vatsim_cid;
 inline std::string vatsim_password;
 inline bool keepWindowOnTop = false;
 
+// Set when replaying a recorded log or running against the mock client,
+// nothing is fetched from the network
+inline bool offlineMode = false;
+
 const int kMinVhf = 118000000; // 118.000
 const int kMaxVhf = 136975000; // 136.975
 const int kObsFrequency = 199998000; // 199.998
@@ -115,6 +116,17 @@ inline static std::chrono::high_resolution_clock::time_point
     currentlyTransmittingApiTimer;
 
 inline int apiServerPort = 49080;
+// Unix domain socket serving the SDK as well, off while empty
+inline std::string apiServerSocket;
+
+// Latest version the updater has seen, used until it gets a fresh answer
+inline std::string lastSeenVersion;
+
+// Logging, levels are spdlog level names
+inline std::string logLevel;
+inline std::string afvLogLevel;
+inline int logFlushInterval = 5;
+inline bool afvJsonLog = false;
 
 // Thread unsafe stuff
 namespace session {
@@ -6,7 +6,8 @@
 namespace vector_audio {
   class SingleInstance {
     public:
-      explicit SingleInstance();
+      // Named instances take their own lock, so several can run side by side
+      explicit SingleInstance(const std::string& instance_name = "");
       ~SingleInstance();
       bool HasRunningInstance() const;
     private:
@@ -0,0 +1,43 @@
+#pragma once
+#include <chrono>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace vector_audio {
+
+// Runs the startup steps and keeps track of how long each one took. Steps
+// that do not need the window can be started in the background and waited
+// on right before their result is needed.
+class Startup {
+public:
+    Startup();
+
+    // Runs a phase on the calling thread
+    void run(const std::string& name, const std::function<void()>& phase);
+
+    // Starts a phase on another thread, it must be joined with wait()
+    void start(const std::string& name, std::function<void()> phase);
+
+    // Waits for a background phase, rethrowing anything it threw
+    void wait(const std::string& name);
+
+    // Logs the time taken by each phase and the total since startup
+    void log_summary(const std::string& milestone);
+
+private:
+    void record(const std::string& name,
+        std::chrono::steady_clock::time_point phase_start);
+
+    std::chrono::steady_clock::time_point start_;
+
+    std::mutex m_;
+    std::vector<std::pair<std::string, std::chrono::milliseconds>> timings_;
+    std::map<std::string, std::future<void>> pending_;
+};
+
+}
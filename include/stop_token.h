@@ -0,0 +1,72 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace vector_audio {
+
+namespace detail {
+    struct StopState {
+        std::atomic<bool> stopped = false;
+        std::mutex m;
+        std::condition_variable cv;
+        std::map<int, std::function<void()>> callbacks;
+        int next_id = 0;
+        // The callback request_stop() is running right now, if any
+        int running = -1;
+    };
+}
+
+// Tells a background task it should wind down, the same idea as the C++20
+// std::stop_token. A default constructed token is never stopped.
+class StopToken {
+public:
+    StopToken() = default;
+
+    bool stop_requested() const { return state_ && state_->stopped; }
+
+private:
+    friend class StopSource;
+    friend class StopCallback;
+
+    explicit StopToken(std::shared_ptr<detail::StopState> state);
+
+    std::shared_ptr<detail::StopState> state_;
+};
+
+class StopSource {
+public:
+    StopSource();
+
+    StopToken get_token() const;
+    bool stop_requested() const { return state_->stopped; }
+
+    // Runs the registered callbacks on the calling thread, only the first
+    // call does anything
+    void request_stop();
+
+private:
+    std::shared_ptr<detail::StopState> state_;
+};
+
+// Runs a callback once stop is requested, for as long as it is alive. Used to
+// abort blocking calls, like an HTTP request in flight. If stop was already
+// requested the callback runs right away, and once the destructor returns the
+// callback is no longer running.
+class StopCallback {
+public:
+    StopCallback(const StopToken& token, std::function<void()> callback);
+    ~StopCallback();
+
+    StopCallback(const StopCallback&) = delete;
+    StopCallback& operator=(const StopCallback&) = delete;
+
+private:
+    std::shared_ptr<detail::StopState> state_;
+    int id_ = -1;
+};
+
+}
@@ -4,10 +4,16 @@
 #include "platform_folders.h"
 #include "shared.h"
 #include "spdlog/spdlog.h"
+#include "stop_token.h"
 #include "util.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <neargye/semver.hpp>
 #include <string>
 #include <thread>
@@ -16,20 +22,50 @@ namespace vector_audio {
 
 class updater {
 public:
-    updater();
+    static constexpr const char* kVersionUrl = "/pierr3/VectorAudio/main/VERSION";
+
+    // How long closing the app waits for the version check to wind down,
+    // after that it is left to finish on its own
+    static constexpr auto kShutdownWait = std::chrono::milliseconds(500);
+
+    // The tests point the version check at a local server
+    explicit updater(const std::string& base_url = "https://raw.githubusercontent.com");
+    ~updater();
 
     bool need_update();
     void draw();
 
 private:
-    bool mNeedUpdate;
+    // Shared with the thread doing the check, which may outlive the updater
+    struct Check {
+        explicit Check(const std::string& base_url)
+            : base_url(base_url)
+            , cli(base_url)
+        {
+        }
+
+        std::string base_url;
+        httplib::Client cli;
+        StopSource stop;
+
+        std::mutex version_lock;
+        semver::version new_version;
+        std::atomic<bool> need_update = false;
+        std::atomic<bool> done = false;
+
+        std::mutex m;
+        std::condition_variable cv;
+        bool finished = false;
+    };
+
+    static void check_version(Check& check);
 
-    std::string mBaseUrl = "https://raw.githubusercontent.com";
-    std::string mVersionUrl = "/pierr3/VectorAudio/main/VERSION";
-    semver::version mNewVersion;
+    std::shared_ptr<Check> mCheck;
+    bool mResultCached = false;
+    bool mDismissed = false;
 
     std::string mArtefactFileUrl = "https://github.com/pierr3/VectorAudio/releases/latest";
-    httplib::Client cli;
+    std::thread mCheckThread;
 };
 
-}
\ No newline at end of file
+}
@@ -4,7 +4,9 @@
 #include <SFML/Window/Keyboard.hpp>
 #include <afv-native/hardwareType.h>
 #include <algorithm>
+#include <cstdlib>
 #include <string>
+#include <string_view>
 #include <utility>
 
 namespace vector_audio::util {
@@ -184,16 +186,80 @@ inline int cleanUpFrequency(int frequency)
     return std::clamp(frequency, 118000000, 136990000);;
 }
 
-static bool endsWith(const std::string& str, const std::string& suffix)
+static bool startsWith(const std::string& str, const std::string& prefix)
+{
+    return str.size() >= prefix.size()
+        && 0 == str.compare(0, prefix.size(), prefix);
+}
+
+static bool endsWith(std::string_view str, std::string_view suffix)
 {
     return str.size() >= suffix.size()
         && 0 == str.compare(str.size() - suffix.size(), suffix.size(), suffix);
 }
 
-static bool startsWith(const std::string& str, const std::string& prefix)
+// Splits a string in place without allocating, the returned tokens are views
+// into the original string, which must outlive the tokenizer. Behaves like
+// shared::split_string, including the trailing empty token.
+class StringTokenizer {
+public:
+    StringTokenizer(std::string_view str, char delimiter)
+        : str_(str)
+        , delimiter_(delimiter)
+    {
+    }
+
+    bool next(std::string_view& token)
+    {
+        if (done_) {
+            return false;
+        }
+
+        auto pos = str_.find(delimiter_);
+        if (pos == std::string_view::npos) {
+            token = str_;
+            done_ = true;
+            return true;
+        }
+
+        token = str_.substr(0, pos);
+        str_.remove_prefix(pos + 1);
+        return true;
+    }
+
+private:
+    std::string_view str_;
+    char delimiter_;
+    bool done_ = false;
+};
+
+// Parses a decimal number out of a view without allocating, returns the
+// fallback if the field is not a number
+inline double toDouble(std::string_view str, double fallback = 0.0)
 {
-    return str.size() >= prefix.size()
-        && 0 == str.compare(0, prefix.size(), prefix);
+    char buffer[32];
+    if (str.empty() || str.size() >= sizeof(buffer)) {
+        return fallback;
+    }
+
+    std::copy(str.begin(), str.end(), buffer);
+    buffer[str.size()] = '\0';
+
+    char* end = nullptr;
+    double value = std::strtod(buffer, &end);
+    return end == buffer ? fallback : value;
+}
+
+// Reads a frequency in MHz, as VATSIM sends them, into Hz. Anything no radio
+// could be tuned to comes out as 0 rather than overflowing the int.
+inline int frequencyFromMHz(std::string_view mhz)
+{
+    auto value = toDouble(mhz);
+    if (!(value > 0.0 && value < 1000.0)) {
+        return 0;
+    }
+
+    return static_cast<int>(value * 1000000);
 }
 
 }
@@ -216,6 +282,11 @@ inline static std::string findHeadsetInputDeviceOrDefault()
         != vector_audio::shared::availableInputDevices.end())
         return vector_audio::shared::configInputDeviceName;
 
+    // If the devices are not enumerated yet, we cannot tell whether the
+    // configured one exists, so we trust it
+    if (vector_audio::shared::availableInputDevices.empty())
+        return vector_audio::shared::configInputDeviceName;
+
     return vector_audio::shared::availableInputDevices.front();
 }
 
@@ -227,6 +298,9 @@ inline static std::string findHeadsetOutputDeviceOrDefault()
         != vector_audio::shared::availableOutputDevices.end())
         return vector_audio::shared::configOutputDeviceName;
 
+    if (vector_audio::shared::availableOutputDevices.empty())
+        return vector_audio::shared::configOutputDeviceName;
+
     return vector_audio::shared::availableOutputDevices.front();
 }
 
@@ -238,5 +312,8 @@ inline static std::string findSpeakerOutputDeviceOrDefault()
         != vector_audio::shared::availableOutputDevices.end())
         return vector_audio::shared::configSpeakerDeviceName;
 
+    if (vector_audio::shared::availableOutputDevices.empty())
+        return vector_audio::shared::configSpeakerDeviceName;
+
     return vector_audio::shared::availableOutputDevices.front();
 }
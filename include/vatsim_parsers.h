@@ -0,0 +1,38 @@
+#pragma once
+#include <nlohmann/json.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// The parsers of the VATSIM responses that need no state from DataHandler.
+// None of them touch the network or the session, so the fuzzers and
+// benchmarks in tests/ can feed them recorded responses.
+namespace vector_audio::vatsim::parsers {
+
+// Views into a single line of a slurper response
+struct SlurperLine {
+    std::string_view callsign;
+    std::string_view type;
+    std::string_view frequency;
+    std::string_view latitude;
+    std::string_view longitude;
+};
+
+bool splitSlurperLine(std::string_view line, SlurperLine& out);
+
+// The v3 datafile URLs of the status file, empty if it has none
+std::vector<std::string> parseStatusFile(const std::string& data);
+
+bool splitDatafileUrl(
+    const std::string& url, std::string& host, std::string& path);
+
+// The position of the first pilot in a slurper response
+bool parsePilotPositionFromSlurper(
+    std::string_view data, double& latitude, double& longitude);
+
+// Element handler for the pilots array of the datafile, it returns true once
+// it found the callsign
+bool matchPilot(const nlohmann::json& pilot, const std::string& callsign,
+    double& latitude, double& longitude);
+
+}
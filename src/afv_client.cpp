@@ -0,0 +1,251 @@
+#include "afv_client.h"
+#include <utility>
+
+namespace vector_audio {
+
+NativeAfvClient::NativeAfvClient(
+    std::string clientName, std::string resourcePath)
+    : client_(std::make_unique<afv_native::api::atcClient>(
+        std::move(clientName), std::move(resourcePath)))
+{
+}
+
+void NativeAfvClient::SetCredentials(std::string username, std::string password)
+{
+    client_->SetCredentials(std::move(username), std::move(password));
+}
+
+void NativeAfvClient::SetCallsign(std::string callsign)
+{
+    client_->SetCallsign(std::move(callsign));
+}
+
+void NativeAfvClient::SetClientPosition(
+    double lat, double lon, double amslm, double aglm)
+{
+    client_->SetClientPosition(lat, lon, amslm, aglm);
+}
+
+bool NativeAfvClient::IsVoiceConnected()
+{
+    return client_->IsVoiceConnected();
+}
+
+bool NativeAfvClient::IsAPIConnected()
+{
+    return client_->IsAPIConnected();
+}
+
+bool NativeAfvClient::Connect()
+{
+    return client_->Connect();
+}
+
+void NativeAfvClient::Disconnect()
+{
+    client_->Disconnect();
+}
+
+void NativeAfvClient::SetAudioApi(unsigned int api)
+{
+    client_->SetAudioApi(api);
+}
+
+std::map<unsigned int, std::string> NativeAfvClient::GetAudioApis()
+{
+    return client_->GetAudioApis();
+}
+
+void NativeAfvClient::SetAudioInputDevice(std::string inputDevice)
+{
+    client_->SetAudioInputDevice(std::move(inputDevice));
+}
+
+std::vector<std::string> NativeAfvClient::GetAudioInputDevices(
+    unsigned int mAudioApi)
+{
+    return client_->GetAudioInputDevices(mAudioApi);
+}
+
+void NativeAfvClient::SetAudioOutputDevice(std::string outputDevice)
+{
+    client_->SetAudioOutputDevice(std::move(outputDevice));
+}
+
+void NativeAfvClient::SetAudioSpeakersOutputDevice(std::string outputDevice)
+{
+    client_->SetAudioSpeakersOutputDevice(std::move(outputDevice));
+}
+
+void NativeAfvClient::SetHeadsetOutputChannel(int channel)
+{
+    client_->SetHeadsetOutputChannel(channel);
+}
+
+std::vector<std::string> NativeAfvClient::GetAudioOutputDevices(
+    unsigned int mAudioApi)
+{
+    return client_->GetAudioOutputDevices(mAudioApi);
+}
+
+double NativeAfvClient::GetInputPeak()
+{
+    return client_->GetInputPeak();
+}
+
+double NativeAfvClient::GetInputVu()
+{
+    return client_->GetInputVu();
+}
+
+void NativeAfvClient::SetEnableInputFilters(bool enableInputFilters)
+{
+    client_->SetEnableInputFilters(enableInputFilters);
+}
+
+void NativeAfvClient::SetEnableOutputEffects(bool enableEffects)
+{
+    client_->SetEnableOutputEffects(enableEffects);
+}
+
+void NativeAfvClient::StartAudio()
+{
+    client_->StartAudio();
+}
+
+void NativeAfvClient::StopAudio()
+{
+    client_->StopAudio();
+}
+
+bool NativeAfvClient::IsAudioRunning()
+{
+    return client_->IsAudioRunning();
+}
+
+void NativeAfvClient::SetTx(unsigned int freq, bool active)
+{
+    client_->SetTx(freq, active);
+}
+
+void NativeAfvClient::SetRx(unsigned int freq, bool active)
+{
+    client_->SetRx(freq, active);
+}
+
+void NativeAfvClient::SetXc(unsigned int freq, bool active)
+{
+    client_->SetXc(freq, active);
+}
+
+void NativeAfvClient::SetOnHeadset(unsigned int freq, bool active)
+{
+    client_->SetOnHeadset(freq, active);
+}
+
+bool NativeAfvClient::GetTxActive(unsigned int freq)
+{
+    return client_->GetTxActive(freq);
+}
+
+bool NativeAfvClient::GetRxActive(unsigned int freq)
+{
+    return client_->GetRxActive(freq);
+}
+
+bool NativeAfvClient::GetOnHeadset(unsigned int freq)
+{
+    return client_->GetOnHeadset(freq);
+}
+
+bool NativeAfvClient::GetTxState(unsigned int freq)
+{
+    return client_->GetTxState(freq);
+}
+
+bool NativeAfvClient::GetRxState(unsigned int freq)
+{
+    return client_->GetRxState(freq);
+}
+
+bool NativeAfvClient::GetXcState(unsigned int freq)
+{
+    return client_->GetXcState(freq);
+}
+
+void NativeAfvClient::UseTransceiversFromStation(std::string station, int freq)
+{
+    client_->UseTransceiversFromStation(std::move(station), freq);
+}
+
+void NativeAfvClient::FetchTransceiverInfo(std::string station)
+{
+    client_->FetchTransceiverInfo(std::move(station));
+}
+
+void NativeAfvClient::FetchStationVccs(std::string station)
+{
+    client_->FetchStationVccs(std::move(station));
+}
+
+void NativeAfvClient::GetStation(std::string station)
+{
+    client_->GetStation(std::move(station));
+}
+
+int NativeAfvClient::GetTransceiverCountForStation(std::string station)
+{
+    return client_->GetTransceiverCountForStation(std::move(station));
+}
+
+void NativeAfvClient::SetPtt(bool pttState)
+{
+    client_->SetPtt(pttState);
+}
+
+void NativeAfvClient::StopAtisPlayback()
+{
+    client_->StopAtisPlayback();
+}
+
+bool NativeAfvClient::IsAtisPlayingBack()
+{
+    return client_->IsAtisPlayingBack();
+}
+
+std::string NativeAfvClient::LastTransmitOnFreq(unsigned int freq)
+{
+    return client_->LastTransmitOnFreq(freq);
+}
+
+void NativeAfvClient::SetRadiosGain(float gain)
+{
+    client_->SetRadiosGain(gain);
+}
+
+void NativeAfvClient::AddFrequency(unsigned int freq, std::string stationName)
+{
+    client_->AddFrequency(freq, std::move(stationName));
+}
+
+void NativeAfvClient::RemoveFrequency(unsigned int freq)
+{
+    client_->RemoveFrequency(freq);
+}
+
+bool NativeAfvClient::IsFrequencyActive(unsigned int freq)
+{
+    return client_->IsFrequencyActive(freq);
+}
+
+void NativeAfvClient::SetHardware(afv_native::HardwareType hardware)
+{
+    client_->SetHardware(hardware);
+}
+
+void NativeAfvClient::RaiseClientEvent(ClientEventCallback callback)
+{
+    client_->RaiseClientEvent(std::move(callback));
+}
+
+}
@@ -0,0 +1,878 @@
+#include "app_core.h"
+#include "afv-native/Log.h"
+#include "profiler.h"
+#include "replay.h"
+#include "util.h"
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <future>
+#include <numeric>
+#include <spdlog/fmt/chrono.h>
+#include <spdlog/spdlog.h>
+#include <thread>
+
+namespace vector_audio::application {
+
+namespace afv_logger {
+    // Set up by Configuration::apply_log_settings() with its own level
+    std::shared_ptr<spdlog::logger> g_afv_log;
+
+    void defaultLogger(const char* subsystem, const char* /*file*/,
+        int /*line*/, const char* lineOut)
+    {
+        g_afv_log->info("{} {}", subsystem, lineOut);
+    }
+
+    afv_native::log_fn g_logger = defaultLogger;
+}
+
+AppCore::AppCore(std::unique_ptr<AfvClient> client)
+    : loop_(kNetworkThreads, kBlockingThreads)
+    , mClient_(std::move(client))
+    , dataHandler_(std::make_unique<vatsim::DataHandler>(loop_))
+{
+    // An injected client enumerates the devices itself, the real one gets a
+    // second instance for the registry's thread
+    AudioDeviceRegistry::ClientFactory make_enumerator;
+
+    if (!mClient_) {
+        try {
+            afv_logger::g_afv_log = spdlog::get("afv_native");
+            if (!afv_logger::g_afv_log) {
+                afv_logger::g_afv_log = spdlog::default_logger();
+            }
+            afv_native::api::atcClient::setLogger(afv_logger::g_logger);
+
+            mClient_ = std::make_unique<NativeAfvClient>(shared::kClientName,
+                vector_audio::Configuration::get_resource_folder().string());
+            spdlog::debug("Created afv_native client.");
+
+            make_enumerator = [] {
+                return std::make_unique<NativeAfvClient>(shared::kClientName,
+                    vector_audio::Configuration::get_resource_folder()
+                        .string());
+            };
+        } catch (std::exception& ex) {
+            spdlog::critical(
+                "Could not create AFV client interface: {}", ex.what());
+            return;
+        }
+    }
+
+    // Fetch all available devices in the background, the configured audio API
+    // is resolved once they are known
+    audioDevices_ = std::make_unique<AudioDeviceRegistry>(
+        mClient_.get(), std::move(make_enumerator));
+
+    // Bind the callbacks from the client
+    mClient_->RaiseClientEvent(
+        [this](auto&& event_type, auto&& data_one, auto&& data_two) {
+            replay::Recorder::record_client_event(
+                event_type, data_one, data_two);
+            eventCallback(std::forward<decltype(event_type)>(event_type),
+                std::forward<decltype(data_one)>(data_one),
+                std::forward<decltype(data_two)>(data_two));
+        });
+
+    // Start the API timer
+    shared::currentlyTransmittingApiTimer
+        = std::chrono::high_resolution_clock::now();
+
+    // Start the SDK server
+    buildSDKServer();
+
+    // Load the airport database async
+    airportLoader_ = std::thread(
+        &vector_audio::application::AppCore::loadAirportsDatabaseAsync,
+        stop_.get_token());
+}
+
+AppCore::~AppCore()
+{
+    // Torn down in order, each step only uses what is still left below it.
+    // SDK requests use everything.
+    closeSDKServer();
+    mSDKSocket_.reset();
+
+    stop_.request_stop();
+    if (airportLoader_.joinable()) {
+        airportLoader_.join();
+    }
+
+    {
+        const std::lock_guard<std::mutex> lock(sdkSubscriptionMutex_);
+        if (sdkChangesSubscription_ >= 0) {
+            dataHandler_->unsubscribeFromChanges(sdkChangesSubscription_);
+        }
+    }
+
+    // Aborts the VATSIM request in flight, if any, and waits for the lookups
+    // still queued
+    dataHandler_.reset();
+
+    // The registry may use the client from its own thread, so it goes before
+    // it
+    audioDevices_.reset();
+    mClient_.reset();
+}
+
+void AppCore::setErrorHandler(
+    std::function<void(const std::string&)> handler)
+{
+    errorHandler_ = std::move(handler);
+}
+
+void AppCore::setUnexpectedDisconnectHandler(std::function<void()> handler)
+{
+    unexpectedDisconnectHandler_ = std::move(handler);
+}
+
+void AppCore::reportError(const std::string& message)
+{
+    if (errorHandler_) {
+        errorHandler_(message);
+        return;
+    }
+
+    spdlog::error("{}", message);
+}
+
+void AppCore::loadAirportsDatabaseAsync(const StopToken& stop)
+{
+    // if we cannot load this database, it's not that important, we will just
+    // log it.
+
+    if (!std::filesystem::exists(
+            vector_audio::Configuration::airports_db_file_path_)) {
+        spdlog::warn("Could not find airport database json file");
+        return;
+    }
+
+    try {
+        // We do performance analysis here
+        auto t1 = std::chrono::high_resolution_clock::now();
+        std::ifstream f(vector_audio::Configuration::airports_db_file_path_);
+        nlohmann::json data = nlohmann::json::parse(f);
+
+        // Loop through all the icaos
+        for (const auto& obj : data.items()) {
+            if (stop.stop_requested()) {
+                return;
+            }
+
+            ns::Airport ar;
+            obj.value().at("icao").get_to(ar.icao);
+            obj.value().at("elevation").get_to(ar.elevation);
+            obj.value().at("lat").get_to(ar.lat);
+            obj.value().at("lon").get_to(ar.lon);
+
+            // Assumption: The user will not have time to connect by the time
+            // this is loaded, hence should be fine re concurrency
+            ns::Airport::All.insert(std::make_pair(obj.key(), ar));
+        }
+
+        auto t2 = std::chrono::high_resolution_clock::now();
+        spdlog::info("Loaded {} airports in {}", ns::Airport::All.size(),
+            std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1));
+    } catch (nlohmann::json::exception& ex) {
+        spdlog::warn("Could parse airport database: {}", ex.what());
+        return;
+    }
+}
+
+std::string AppCore::sdkResponse(bool is_get, std::string_view target)
+{
+    if (is_get && target == "/transmitting") {
+        const std::lock_guard<std::mutex> lock(
+            vector_audio::shared::transmitting_mutex);
+        return vector_audio::shared::currentlyTransmittingApiData;
+    }
+    if (is_get && target == "/rx") {
+        std::vector<shared::StationElement> bar;
+
+        // copy only positive numbers:
+        std::copy_if(shared::FetchedStations.begin(),
+            shared::FetchedStations.end(), std::back_inserter(bar),
+            [this](const shared::StationElement& s) {
+                if (!mClient_->IsVoiceConnected())
+                    return false;
+                return mClient_->GetRxState(s.freq);
+            });
+
+        std::string out;
+        if (!bar.empty()) {
+            for (auto& f : bar) {
+                out += f.callsign + ":" + f.human_freq + ",";
+            }
+        }
+
+        if (out.back() == ',') {
+            out.pop_back();
+        }
+
+        return out;
+    }
+    if (is_get && target == "/tx") {
+        std::vector<shared::StationElement> bar;
+
+        // copy only positive numbers:
+        std::copy_if(shared::FetchedStations.begin(),
+            shared::FetchedStations.end(), std::back_inserter(bar),
+            [this](const shared::StationElement& s) {
+                if (!mClient_->IsVoiceConnected())
+                    return false;
+                return mClient_->GetTxState(s.freq);
+            });
+
+        std::string out;
+        if (!bar.empty()) {
+            for (auto& f : bar) {
+                out += f.callsign + ":" + f.human_freq + ",";
+            }
+        }
+
+        if (out.back() == ',') {
+            out.pop_back();
+        }
+
+        return out;
+    }
+
+    auto query_start = target.find('?');
+    auto path = target.substr(0, query_start);
+    if (is_get && path == "/changes") {
+        subscribeSDKToChanges();
+
+        std::uint64_t since = 0;
+        if (query_start != std::string_view::npos) {
+            auto query = restinio::parse_query(target.substr(query_start + 1));
+            auto param = query.get_param("since");
+            if (param) {
+                std::from_chars(
+                    param->data(), param->data() + param->size(), since);
+            }
+        }
+
+        return sdkChangesSince(since);
+    }
+
+    return vector_audio::shared::kClientName;
+}
+
+void AppCore::buildSDKServer()
+{
+    try {
+        mSDKServer_ = std::make_unique<restinio::http_server_t<>>(
+            restinio::external_io_context(loop_.context()),
+            restinio::server_settings_t<> {}
+                .port(vector_audio::shared::apiServerPort)
+                .address("0.0.0.0")
+                .request_handler([&](auto req) {
+                    return req->create_response()
+                        .set_body(sdkResponse(restinio::http_method_get()
+                                == req->header().method(),
+                            req->header().request_target()))
+                        .done();
+                }));
+
+        mSDKServer_->open_async([] { spdlog::debug("SDK server listening"); },
+            [](const std::exception_ptr& ex) {
+                spdlog::error(
+                    "Failed to created SDK http server, is the port in use?");
+                try {
+                    std::rethrow_exception(ex);
+                } catch (std::exception& e) {
+                    spdlog::error("{}", e.what());
+                }
+            });
+    } catch (std::exception& ex) {
+        spdlog::error("Failed to created SDK http server, is the port in use?");
+        spdlog::error("{}", ex.what());
+    }
+
+    // Local clients can skip TCP altogether, with the socket file permissions
+    // deciding who may connect
+    if (!shared::apiServerSocket.empty()) {
+        mSDKSocket_ = std::make_unique<SDKSocketServer>(loop_,
+            shared::apiServerSocket,
+            [this](bool is_get, std::string_view target) {
+                return sdkResponse(is_get, target);
+            });
+    }
+}
+
+void AppCore::closeSDKServer()
+{
+    if (!mSDKServer_) {
+        return;
+    }
+
+    // The server lives on the loop threads, so it is closed from there
+    std::promise<void> closed;
+    mSDKServer_->close_async([&closed] { closed.set_value(); },
+        [&closed](const std::exception_ptr& /*ex*/) { closed.set_value(); });
+    closed.get_future().wait();
+
+    mSDKServer_.reset();
+}
+
+void AppCore::subscribeSDKToChanges()
+{
+    const std::lock_guard<std::mutex> lock(sdkSubscriptionMutex_);
+    lastSDKChangesRequest_ = std::chrono::steady_clock::now();
+    if (sdkChangesSubscription_ >= 0) {
+        return;
+    }
+
+    sdkChangesSubscription_ = dataHandler_->subscribeToChanges(
+        [this](const std::vector<vatsim::DatafileChange>& changes) {
+            queueSDKChanges(changes);
+        });
+}
+
+void AppCore::dropIdleSDKSubscription()
+{
+    const std::lock_guard<std::mutex> lock(sdkSubscriptionMutex_);
+    if (sdkChangesSubscription_ < 0
+        || std::chrono::steady_clock::now() - lastSDKChangesRequest_
+            < kSDKChangesIdle) {
+        return;
+    }
+
+    // The next subscriber gets the whole network again as added entries
+    dataHandler_->unsubscribeFromChanges(sdkChangesSubscription_);
+    sdkChangesSubscription_ = -1;
+    spdlog::debug("No SDK client asked for changes lately, unsubscribed");
+}
+
+void AppCore::queueSDKChanges(
+    const std::vector<vatsim::DatafileChange>& changes)
+{
+    // A few polls worth of moving pilots
+    constexpr std::size_t kMaxSDKChanges = 5000;
+
+    const std::lock_guard<std::mutex> lock(sdkChangesMutex_);
+    for (const auto& change : changes) {
+        const auto& entry = change.entry;
+        auto detail = entry.is_controller
+            ? fmt::format("{:.3f}", entry.frequency / 1000000.0)
+            : fmt::format("{:.4f},{:.4f}", entry.latitude, entry.longitude);
+
+        auto id = nextSDKChange_++;
+        sdkChanges_.emplace_back(id,
+            fmt::format("{}:{}:{}:{}", id, vatsim::changeTypeName(change.type),
+                entry.callsign, detail));
+    }
+
+    while (sdkChanges_.size() > kMaxSDKChanges) {
+        sdkChanges_.pop_front();
+    }
+}
+
+std::string AppCore::sdkChangesSince(std::uint64_t since)
+{
+    const std::lock_guard<std::mutex> lock(sdkChangesMutex_);
+
+    std::string out;
+    auto it = std::upper_bound(sdkChanges_.begin(), sdkChanges_.end(), since,
+        [](std::uint64_t id, const auto& change) { return id < change.first; });
+    for (; it != sdkChanges_.end(); ++it) {
+        out += it->second;
+        out += '\n';
+    }
+    return out;
+}
+
+void AppCore::eventCallback(
+    afv_native::ClientEventType evt, void* data, void* data2)
+{
+    if (evt == afv_native::ClientEventType::VccsReceived) {
+        if (data != nullptr && data2 != nullptr) {
+            // We got new VCCS stations, we can add them to our list and start
+            // getting their transceivers
+            std::map<std::string, unsigned int> stations
+                = *reinterpret_cast<std::map<std::string, unsigned int>*>(
+                    data2);
+
+            if (mClient_->IsVoiceConnected()) {
+                for (auto s : stations) {
+                    if (!util::isValid8_33kHzChannel(s.second)) {
+                        s.second = util::round8_33kHzChannel(s.second);
+                    }
+                    shared::StationElement el
+                        = shared::StationElement::build(s.first, s.second);
+
+                    if (!frequencyExists(el.freq))
+                        shared::FetchedStations.push_back(el);
+                }
+            }
+        }
+    }
+
+    if (evt == afv_native::ClientEventType::StationTransceiversUpdated) {
+        if (data != nullptr) {
+            // We just refresh the transceiver count in our display
+            std::string station = *reinterpret_cast<std::string*>(data);
+            auto it = std::find_if(shared::FetchedStations.begin(),
+                shared::FetchedStations.end(),
+                [station](const auto& fs) { return fs.callsign == station; });
+            if (it != shared::FetchedStations.end())
+                it->transceivers
+                    = mClient_->GetTransceiverCountForStation(station);
+        }
+    }
+
+    if (evt == afv_native::ClientEventType::APIServerError) {
+        // We got an error from the API server, we can display this to the user
+        if (data != nullptr) {
+            afv_native::afv::APISessionError err
+                = *reinterpret_cast<afv_native::afv::APISessionError*>(data);
+
+            if (err == afv_native::afv::APISessionError::BadPassword
+                || err
+                    == afv_native::afv::APISessionError::RejectedCredentials) {
+                reportError("Could not login to VATSIM.\nInvalid "
+                            "Credentials.\nCheck your password/cid!");
+
+                spdlog::error("Got invalid credential errors from AFV API: "
+                              "HTTP 403 or 401");
+            }
+
+            if (err == afv_native::afv::APISessionError::ConnectionError) {
+                reportError("Could not login to VATSIM.\nConnection "
+                            "Error.\nCheck your internet connection.");
+
+                spdlog::error("Got connection error from AFV API: local socket "
+                              "or curl error");
+            }
+
+            if (err
+                == afv_native::afv::APISessionError::
+                    BadRequestOrClientIncompatible) {
+                reportError("Could not login to VATSIM.\n Bad Request or "
+                            "Client Incompatible.");
+
+                spdlog::error("Got connection error from AFV API: HTTP 400 - "
+                              "Bad Request or Client Incompatible");
+            }
+
+            if (err == afv_native::afv::APISessionError::InvalidAuthToken) {
+                reportError(
+                    "Could not login to VATSIM.\n Invalid Auth Token.");
+
+                spdlog::error("Got connection error from AFV API: Invalid Auth "
+                              "Token Local Parse Error.");
+            }
+
+            if (err
+                == afv_native::afv::APISessionError::
+                    AuthTokenExpiryTimeInPast) {
+                reportError("Could not login to VATSIM.\n Auth Token has "
+                            "expired.\n Check your system clock.");
+
+                spdlog::error("Got connection error from AFV API: Auth Token "
+                              "Expiry in the past");
+            }
+
+            if (err == afv_native::afv::APISessionError::OtherRequestError) {
+                reportError("Could not login to VATSIM.\n Unknown Error.");
+
+                spdlog::error(
+                    "Got connection error from AFV API: Unknown Error");
+            }
+        }
+    }
+
+    if (evt == afv_native::ClientEventType::AudioError) {
+        reportError("Error starting audio devices.\nPlease check "
+                    "your log file for details.\nCheck your audio config!");
+    }
+
+    if (evt == afv_native::ClientEventType::VoiceServerDisconnected) {
+        if (!manuallyDisconnected_ && unexpectedDisconnectHandler_) {
+            unexpectedDisconnectHandler_();
+        }
+
+        manuallyDisconnected_ = false;
+    }
+
+    if (evt == afv_native::ClientEventType::VoiceServerError) {
+        int err_code = *reinterpret_cast<int*>(data);
+        reportError("Voice server returned error " + std::to_string(err_code)
+            + ", please check the log file.");
+    }
+
+    if (evt == afv_native::ClientEventType::VoiceServerChannelError) {
+        int err_code = *reinterpret_cast<int*>(data);
+        reportError("Voice server returned channel error "
+            + std::to_string(err_code) + ", please check the log file.");
+    }
+
+    if (evt == afv_native::ClientEventType::StationDataReceived) {
+        if (data != nullptr && data2 != nullptr) {
+            // We just refresh the transceiver count in our display
+            bool found = *reinterpret_cast<bool*>(data);
+            if (found) {
+                auto station
+                    = *reinterpret_cast<std::pair<std::string, unsigned int>*>(
+                        data2);
+
+                station.second = util::cleanUpFrequency(station.second);
+
+                shared::StationElement el = shared::StationElement::build(
+                    station.first, station.second);
+
+                if (!frequencyExists(el.freq))
+                    shared::FetchedStations.push_back(el);
+            } else {
+                reportError("Could not find station in database.");
+                spdlog::warn(
+                    "Station not found in AFV database through search");
+            }
+        }
+    }
+}
+
+
+void AppCore::tick()
+{
+    if (audioDevices_) {
+        audioDevices_->update();
+    }
+
+    dropIdleSDKSubscription();
+
+    if (!mClient_) {
+        return;
+    }
+
+    // AFV stuff
+    {
+        Profiler::Scope afv_scope("AFV polling");
+        vector_audio::shared::mPeak = mClient_->GetInputPeak();
+        vector_audio::shared::mVu = mClient_->GetInputVu();
+
+        if (mClient_->IsAPIConnected() && shared::FetchedStations.empty()
+            && !shared::bootUpVccs) {
+            addBootUpStation();
+        }
+
+        // Auto disconnect if the VATSIM session is gone
+        if (isConnected() && !shared::session::is_connected) {
+            disconnect(false);
+        }
+    }
+
+    processPendingStations();
+    processPilotLookups();
+    updateReceivedCallsigns();
+}
+
+void AppCore::addBootUpStation()
+{
+    // We force add the current user frequency
+    shared::bootUpVccs = true;
+
+    // We replaced double _ which may be used during frequency
+    // handovers, but are not defined in database
+    std::string clean_callsign = vector_audio::util::ReplaceString(
+        shared::session::callsign, "__", "_");
+
+    shared::StationElement el = shared::StationElement::build(
+        clean_callsign, shared::session::frequency);
+    if (!frequencyExists(el.freq))
+        shared::FetchedStations.push_back(el);
+
+    this->mClient_->AddFrequency(shared::session::frequency, clean_callsign);
+    mClient_->SetEnableInputFilters(vector_audio::shared::mInputFilter);
+    mClient_->SetEnableOutputEffects(vector_audio::shared::mOutputEffects);
+    this->mClient_->UseTransceiversFromStation(
+        clean_callsign, shared::session::frequency);
+    this->mClient_->SetRx(shared::session::frequency, true);
+    if (shared::session::facility > 0) {
+        this->mClient_->SetTx(shared::session::frequency, true);
+        this->mClient_->SetXc(shared::session::frequency, true);
+    }
+    this->mClient_->FetchStationVccs(clean_callsign);
+    mClient_->SetRadiosGain(shared::RadioGain / 100.0F);
+}
+
+void AppCore::processPendingStations()
+{
+    Profiler::Scope pending_scope("Pending removals");
+
+    // Forcing removal of unused stations if possible, otherwise we try at the
+    // next loop
+    shared::StationsPendingRemoval.erase(
+        std::remove_if(shared::StationsPendingRemoval.begin(),
+            shared::StationsPendingRemoval.end(),
+            [this](int const& station) {
+                // First we check if we are not receiving or transmitting
+                // on the frequency
+                if (!this->mClient_->GetRxActive(station)
+                    && !this->mClient_->GetTxActive(station)) {
+                    // The frequency is free, we can remove it
+
+                    shared::FetchedStations.erase(
+                        std::remove_if(shared::FetchedStations.begin(),
+                            shared::FetchedStations.end(),
+                            [station](shared::StationElement const& p) {
+                                return station == p.freq;
+                            }),
+                        shared::FetchedStations.end());
+                    mClient_->RemoveFrequency(station);
+
+                    return true;
+                } // The frequency is not free, we try again later
+                return false;
+            }),
+        shared::StationsPendingRemoval.end());
+
+    // Changing RX status that is locked
+    shared::StationsPendingRxChange.erase(
+        std::remove_if(shared::StationsPendingRxChange.begin(),
+            shared::StationsPendingRxChange.end(),
+            [this](int const& station) {
+                if (!this->mClient_->GetRxActive(station)) {
+                    // Frequency is free, we can change the state
+                    this->mClient_->SetRx(
+                        station, !this->mClient_->GetRxState(station));
+                    return true;
+                } // Frequency is not free, we try again later
+                return false;
+            }),
+        shared::StationsPendingRxChange.end());
+}
+
+void AppCore::updateReceivedCallsigns()
+{
+    receivedCallsigns_.clear();
+    liveReceivedCallsigns_.clear();
+
+    for (const auto& el : shared::FetchedStations) {
+        if (!mClient_->GetRxState(el.freq)) {
+            continue;
+        }
+
+        auto received_cld = mClient_->LastTransmitOnFreq(el.freq);
+        if (received_cld.empty()) {
+            continue;
+        }
+
+        if (std::find(receivedCallsigns_.begin(), receivedCallsigns_.end(),
+                received_cld)
+            == receivedCallsigns_.end()) {
+            receivedCallsigns_.push_back(received_cld);
+        }
+
+        // Here we filter not the last callsigns that transmitted, but only the
+        // ones that are currently transmitting
+        if (mClient_->GetRxActive(el.freq)
+            && std::find(liveReceivedCallsigns_.begin(),
+                   liveReceivedCallsigns_.end(), received_cld)
+                == liveReceivedCallsigns_.end()) {
+            liveReceivedCallsigns_.push_back(received_cld);
+        }
+    }
+
+    // Clear out the old API data every 300ms
+    auto current_time = std::chrono::high_resolution_clock::now();
+    if (std::chrono::duration_cast<std::chrono::milliseconds>(
+            current_time - shared::currentlyTransmittingApiTimer)
+            .count()
+        >= 300) {
+        const std::lock_guard<std::mutex> lock(
+            vector_audio::shared::transmitting_mutex);
+        shared::currentlyTransmittingApiData = "";
+
+        shared::currentlyTransmittingApiData.append(
+            liveReceivedCallsigns_.empty()
+                ? ""
+                : std::accumulate(++liveReceivedCallsigns_.begin(),
+                    liveReceivedCallsigns_.end(),
+                    *liveReceivedCallsigns_.begin(),
+                    [](const auto& a, const auto& b) {
+                        return a + "," + b;
+                    }));
+        shared::currentlyTransmittingApiTimer = current_time;
+    }
+}
+
+bool AppCore::isConnected() const
+{
+    return mClient_
+        && (mClient_->IsVoiceConnected() || mClient_->IsAPIConnected());
+}
+
+bool AppCore::connect()
+{
+    if (!vector_audio::shared::session::is_connected
+        && dataHandler_->isSlurperAvailable()) {
+        // We manually check the session here in case that we do not have a
+        // connection yet. Although this will block the caller, it is not an
+        // issue in this case as the user does not need to interact with the
+        // software while we attempt. A slow slurper is raced against the
+        // datafile, so this does not wait on it for long.
+
+        vector_audio::shared::session::is_connected
+            = dataHandler_->checkSessionNow();
+    }
+
+    if (!vector_audio::shared::session::is_connected) {
+        reportError("Not connected to VATSIM!");
+        return false;
+    }
+
+    if (mClient_->IsAudioRunning()) {
+        mClient_->StopAudio();
+    }
+    if (mClient_->IsAPIConnected()) {
+        mClient_->Disconnect(); // Force a disconnect of API
+    }
+
+    mClient_->SetAudioApi(findAudioAPIorDefault());
+    mClient_->SetAudioInputDevice(findHeadsetInputDeviceOrDefault());
+    mClient_->SetAudioOutputDevice(findHeadsetOutputDeviceOrDefault());
+    mClient_->SetAudioSpeakersOutputDevice(findSpeakerOutputDeviceOrDefault());
+    mClient_->SetHardware(vector_audio::shared::hardware);
+    mClient_->SetHeadsetOutputChannel(
+        vector_audio::shared::headsetOutputChannel);
+
+    if (!dataHandler_->isSlurperAvailable()) {
+        std::string client_icao
+            = vector_audio::shared::session::callsign.substr(
+                0, vector_audio::shared::session::callsign.find('_'));
+        // We use the airport database for this
+        if (ns::Airport::All.find(client_icao) != ns::Airport::All.end()) {
+            auto client_airport = ns::Airport::All.at(client_icao);
+
+            // We pad the elevation by 10 meters to simulate the client being
+            // in a tower
+            mClient_->SetClientPosition(client_airport.lat, client_airport.lon,
+                client_airport.elevation + 33, client_airport.elevation + 33);
+
+            spdlog::info("Found client position in database at "
+                         "lat:{}, lon:{}, elev:{}",
+                client_airport.lat, client_airport.lon,
+                client_airport.elevation);
+        } else {
+            spdlog::warn("Client position is unknown, setting default.");
+
+            // Default position is over Paris somewhere
+            mClient_->SetClientPosition(48.967860, 2.442000, 300, 300);
+        }
+    } else {
+        spdlog::info("Found client position from slurper at lat:{}, lon:{}",
+            vector_audio::shared::session::latitude,
+            vector_audio::shared::session::longitude);
+        mClient_->SetClientPosition(vector_audio::shared::session::latitude,
+            vector_audio::shared::session::longitude, 300, 300);
+    }
+
+    mClient_->SetCredentials(std::to_string(vector_audio::shared::vatsim_cid),
+        vector_audio::shared::vatsim_password);
+    mClient_->SetCallsign(vector_audio::shared::session::callsign);
+    mClient_->SetRadiosGain(shared::RadioGain / 100.0F);
+    mClient_->StartAudio();
+    if (!mClient_->Connect()) {
+        mClient_->StopAudio();
+        spdlog::error("Failed to connect: afv_lib says API is connected.");
+        return false;
+    }
+
+    return true;
+}
+
+void AppCore::disconnect(bool manual)
+{
+    if (manual) {
+        manuallyDisconnected_ = true;
+    }
+
+    if (mClient_->IsAtisPlayingBack())
+        mClient_->StopAtisPlayback();
+
+    // Cleanup everything
+    for (const auto& f : shared::FetchedStations)
+        mClient_->RemoveFrequency(f.freq);
+    mClient_->Disconnect();
+
+    shared::FetchedStations.clear();
+    shared::bootUpVccs = false;
+}
+
+void AppCore::addStation(const std::string& callsign)
+{
+    if (!mClient_->IsVoiceConnected()) {
+        return;
+    }
+
+    if (!util::startsWith(callsign, "!")) {
+        mClient_->GetStation(callsign);
+        mClient_->FetchStationVccs(callsign);
+        return;
+    }
+
+    auto pilot_callsign = callsign.substr(1);
+
+    if (frequencyExists(shared::kUnicomFrequency)) {
+        reportError("Another UNICOM frequency is active, please delete it "
+                    "first.");
+        return;
+    }
+
+    // The lookup can take a few seconds, the station is added by tick()
+    dataHandler_->findPilotPosition(pilot_callsign,
+        [this, pilot_callsign](bool found, double latitude, double longitude) {
+            const std::lock_guard<std::mutex> lock(pilotLookupsMutex_);
+            pilotLookups_.push_back(
+                { pilot_callsign, found, latitude, longitude });
+        });
+}
+
+void AppCore::processPilotLookups()
+{
+    std::vector<PilotLookup> lookups;
+    {
+        const std::lock_guard<std::mutex> lock(pilotLookupsMutex_);
+        lookups.swap(pilotLookups_);
+    }
+
+    for (const auto& lookup : lookups) {
+        if (!mClient_->IsVoiceConnected()) {
+            return;
+        }
+
+        if (!lookup.found) {
+            reportError("Could not find pilot connected under that callsign.");
+            continue;
+        }
+
+        // Another one may have been added while this one was looked up
+        if (frequencyExists(shared::kUnicomFrequency)) {
+            reportError("Another UNICOM frequency is active, please delete "
+                        "it first.");
+            continue;
+        }
+
+        shared::StationElement el = shared::StationElement::build(
+            lookup.callsign, shared::kUnicomFrequency);
+
+        shared::FetchedStations.push_back(el);
+        mClient_->SetClientPosition(
+            lookup.latitude, lookup.longitude, 1000, 1000);
+        mClient_->AddFrequency(shared::kUnicomFrequency, lookup.callsign);
+        mClient_->SetRx(shared::kUnicomFrequency, true);
+        mClient_->SetRadiosGain(shared::RadioGain / 100.0F);
+    }
+}
+
+bool AppCore::frequencyExists(int freq)
+{
+    return std::find_if(shared::FetchedStations.begin(),
+               shared::FetchedStations.end(),
+               [&freq](const auto& obj) { return obj.freq == freq; })
+        != shared::FetchedStations.end();
+}
+} // namespace vector_audio::application
@@ -1,132 +1,28 @@
 #include "application.h"
-#include "afv-native/Log.h"
-#include "afv-native/atcClientWrapper.h"
 #include "afv-native/event.h"
 #include "config.h"
 #include "data_file_handler.h"
 #include "imgui.h"
 #include "imgui_internal.h"
+#include "profiler.h"
+#include "replay.h"
 #include "shared.h"
 #include "style.h"
 #include "util.h"
 #include <SFML/Audio/Sound.hpp>
 #include <SFML/Audio/SoundBuffer.hpp>
 #include <SFML/Window/Joystick.hpp>
-#include <httplib.h>
 #include <memory>
 #include <spdlog/spdlog.h>
 
 namespace vector_audio::application {
 using util::TextURL;
 
-namespace afv_logger {
-    void defaultLogger(const char* subsystem, const char* /*file*/,
-        int /*line*/, const char* lineOut)
-    {
-        spdlog::info("[afv_native] {} {}", subsystem, lineOut);
-    }
-
-    afv_native::log_fn g_logger = defaultLogger;
-}
-
-App::App()
-    : dataHandler_(std::make_unique<vatsim::DataHandler>())
+App::App(std::unique_ptr<AfvClient> client)
+    : core_(std::make_unique<AppCore>(std::move(client)))
 {
-    try {
-        afv_native::api::atcClient::setLogger(afv_logger::g_logger);
-
-        mClient_ = new afv_native::api::atcClient(shared::kClientName,
-            vector_audio::Configuration::get_resource_folder().string());
-
-        // Fetch all available devices on start
-        vector_audio::shared::availableAudioAPI = mClient_->GetAudioApis();
-        vector_audio::shared::availableInputDevices
-            = mClient_->GetAudioInputDevices(vector_audio::shared::mAudioApi);
-        vector_audio::shared::availableOutputDevices
-            = mClient_->GetAudioOutputDevices(vector_audio::shared::mAudioApi);
-        spdlog::debug("Created afv_native client.");
-    } catch (std::exception& ex) {
-        spdlog::critical(
-            "Could not create AFV client interface: {}", ex.what());
-        return;
-    }
-
-    // Load all from config
-    try {
-        using cfg = vector_audio::Configuration;
-
-        vector_audio::shared::mOutputEffects
-            = toml::find_or<bool>(cfg::config_, "audio", "vhf_effects", true);
-        vector_audio::shared::mInputFilter
-            = toml::find_or<bool>(cfg::config_, "audio", "input_filters", true);
-
-        vector_audio::shared::vatsim_cid
-            = toml::find_or<int>(cfg::config_, "user", "vatsim_id", 999999);
-        vector_audio::shared::vatsim_password = toml::find_or<std::string>(
-            cfg::config_, "user", "vatsim_password", std::string("password"));
-
-        vector_audio::shared::keepWindowOnTop = toml::find_or<bool>(
-            cfg::config_, "user", "keepWindowOnTop", false);
-
-        vector_audio::shared::ptt = static_cast<sf::Keyboard::Scancode>(
-            toml::find_or<int>(cfg::config_, "user", "ptt",
-                static_cast<int>(sf::Keyboard::Scan::Unknown)));
-
-        vector_audio::shared::joyStickId = static_cast<int>(
-            toml::find_or<int>(cfg::config_, "user", "joyStickId", -1));
-        vector_audio::shared::joyStickPtt = static_cast<int>(
-            toml::find_or<int>(cfg::config_, "user", "joyStickPtt", -1));
-
-        auto audio_providers = mClient_->GetAudioApis();
-        vector_audio::shared::configAudioApi = toml::find_or<std::string>(
-            cfg::config_, "audio", "api", std::string("Default API"));
-        for (const auto& driver : audio_providers) {
-            if (driver.second == vector_audio::shared::configAudioApi)
-                vector_audio::shared::mAudioApi = driver.first;
-        }
-
-        vector_audio::shared::configInputDeviceName
-            = toml::find_or<std::string>(
-                cfg::config_, "audio", "input_device", std::string(""));
-        vector_audio::shared::configOutputDeviceName
-            = toml::find_or<std::string>(
-                cfg::config_, "audio", "output_device", std::string(""));
-        vector_audio::shared::configSpeakerDeviceName
-            = toml::find_or<std::string>(
-                cfg::config_, "audio", "speaker_device", std::string(""));
-        vector_audio::shared::headsetOutputChannel
-            = toml::find_or<int>(cfg::config_, "audio", "headset_channel", 0);
-
-        vector_audio::shared::hardware = static_cast<afv_native::HardwareType>(
-            toml::find_or<int>(cfg::config_, "audio", "hardware_type", 0));
-
-        vector_audio::shared::apiServerPort
-            = toml::find_or<int>(cfg::config_, "general", "api_port", 49080);
-    } catch (toml::exception& exc) {
-        spdlog::error(
-            "Failed to parse available configuration: {}", exc.what());
-    }
-
-    // Bind the callbacks from the client
-    // std::bind(&App::_eventCallback, this, std::placeholders::_1,
-    // std::placeholders::_2, std::placeholders::_3)
-    mClient_->RaiseClientEvent(
-        [this](auto&& event_type, auto&& data_one, auto&& data_two) {
-            eventCallback(std::forward<decltype(event_type)>(event_type),
-                std::forward<decltype(data_one)>(data_one),
-                std::forward<decltype(data_two)>(data_two));
-        });
-
-    // Start the API timer
-    shared::currentlyTransmittingApiTimer
-        = std::chrono::high_resolution_clock::now();
-
-    // Start the SDK server
-    buildSDKServer();
-
-    // Load the airport database async
-    std::thread(&vector_audio::application::App::loadAirportsDatabaseAsync)
-        .detach();
+    core_->setErrorHandler(
+        [this](const std::string& message) { errorModal(message); });
 
     // Load the warning sound for disconnection
     auto sound_path = Configuration::get_resource_folder()
@@ -134,408 +30,69 @@ App::App()
     if (!disconnectWarningSoundbuffer_.loadFromFile(sound_path.string())) {
         spdlog::error(
             "Could not load warning sound file, disconnection will be silent");
-        disconnectWarningSoundAvailable_ = false;
-    }
-
-    soundPlayer_.setBuffer(disconnectWarningSoundbuffer_);
-}
-
-App::~App() { delete mClient_; }
-
-void App::loadAirportsDatabaseAsync()
-{
-    // if we cannot load this database, it's not that important, we will just
-    // log it.
-
-    if (!std::filesystem::exists(
-            vector_audio::Configuration::airports_db_file_path_)) {
-        spdlog::warn("Could not find airport database json file");
         return;
     }
 
-    try {
-        // We do performance analysis here
-        auto t1 = std::chrono::high_resolution_clock::now();
-        std::ifstream f(vector_audio::Configuration::airports_db_file_path_);
-        nlohmann::json data = nlohmann::json::parse(f);
-
-        // Loop through all the icaos
-        for (const auto& obj : data.items()) {
-            ns::Airport ar;
-            obj.value().at("icao").get_to(ar.icao);
-            obj.value().at("elevation").get_to(ar.elevation);
-            obj.value().at("lat").get_to(ar.lat);
-            obj.value().at("lon").get_to(ar.lon);
-
-            // Assumption: The user will not have time to connect by the time
-            // this is loaded, hence should be fine re concurrency
-            ns::Airport::All.insert(std::make_pair(obj.key(), ar));
-        }
-
-        auto t2 = std::chrono::high_resolution_clock::now();
-        spdlog::info("Loaded {} airports in {}", ns::Airport::All.size(),
-            std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1));
-    } catch (nlohmann::json::exception& ex) {
-        spdlog::warn("Could parse airport database: {}", ex.what());
-        return;
-    }
+    soundPlayer_.setBuffer(disconnectWarningSoundbuffer_);
+    core_->setUnexpectedDisconnectHandler([this]() { soundPlayer_.play(); });
 }
 
-void App::buildSDKServer()
-{
-    try {
-        mSDKServer_ = restinio::run_async<>(restinio::own_io_context(),
-            restinio::server_settings_t<> {}
-                .port(vector_audio::shared::apiServerPort)
-                .address("0.0.0.0")
-                .request_handler([&](auto req) {
-                    if (restinio::http_method_get() == req->header().method()
-                        && req->header().request_target() == "/transmitting") {
-
-                        const std::lock_guard<std::mutex> lock(
-                            vector_audio::shared::transmitting_mutex);
-                        return req->create_response()
-                            .set_body(vector_audio::shared::
-                                    currentlyTransmittingApiData)
-                            .done();
-                    }
-                    if (restinio::http_method_get() == req->header().method()
-                        && req->header().request_target() == "/rx") {
-                        std::vector<shared::StationElement> bar;
-
-                        // copy only positive numbers:
-                        std::copy_if(shared::FetchedStations.begin(),
-                            shared::FetchedStations.end(),
-                            std::back_inserter(bar),
-                            [this](const shared::StationElement& s) {
-                                if (!mClient_->IsVoiceConnected())
-                                    return false;
-                                return mClient_->GetRxState(s.freq);
-                            });
-
-                        std::string out;
-                        if (!bar.empty()) {
-                            for (auto& f : bar) {
-                                out += f.callsign + ":" + f.human_freq + ",";
-                            }
-                        }
-
-                        if (out.back() == ',') {
-                            out.pop_back();
-                        }
-
-                        return req->create_response().set_body(out).done();
-                    }
-                    if (restinio::http_method_get() == req->header().method()
-                        && req->header().request_target() == "/tx") {
-                        std::vector<shared::StationElement> bar;
-
-                        // copy only positive numbers:
-                        std::copy_if(shared::FetchedStations.begin(),
-                            shared::FetchedStations.end(),
-                            std::back_inserter(bar),
-                            [this](const shared::StationElement& s) {
-                                if (!mClient_->IsVoiceConnected())
-                                    return false;
-                                return mClient_->GetTxState(s.freq);
-                            });
-
-                        std::string out;
-                        if (!bar.empty()) {
-                            for (auto& f : bar) {
-                                out += f.callsign + ":" + f.human_freq + ",";
-                            }
-                        }
-
-                        if (out.back() == ',') {
-                            out.pop_back();
-                        }
-
-                        return req->create_response().set_body(out).done();
-                    }
-
-                    return req->create_response()
-                        .set_body(vector_audio::shared::kClientName)
-                        .done();
-                }),
-            16U);
-    } catch (std::exception& ex) {
-        spdlog::error("Failed to created SDK http server, is the port in use?");
-        spdlog::error("%{}", ex.what());
-    }
-}
+App::~App() = default;
 
-void App::eventCallback(
-    afv_native::ClientEventType evt, void* data, void* data2)
+void App::pollPtt()
 {
-    if (evt == afv_native::ClientEventType::VccsReceived) {
-        if (data != nullptr && data2 != nullptr) {
-            // We got new VCCS stations, we can add them to our list and start
-            // getting their transceivers
-            std::map<std::string, unsigned int> stations
-                = *reinterpret_cast<std::map<std::string, unsigned int>*>(
-                    data2);
-
-            if (mClient_->IsVoiceConnected()) {
-                for (auto s : stations) {
-                    if (!util::isValid8_33kHzChannel(s.second)) {
-                        s.second = util::round8_33kHzChannel(s.second);
-                    }
-                    shared::StationElement el
-                        = shared::StationElement::build(s.first, s.second);
-
-                    if (!frequencyExists(el.freq))
-                        shared::FetchedStations.push_back(el);
+    auto* client = core_->client();
+    bool was_ptt_open = shared::isPttOpen;
+
+    // Set the Ptt if required, input based on event
+    if (client->IsVoiceConnected()
+        && (shared::ptt != sf::Keyboard::Scan::Unknown
+            || shared::joyStickId != -1)) {
+        if (shared::isPttOpen) {
+            if (shared::joyStickId != -1) {
+                if (!sf::Joystick::isButtonPressed(
+                        shared::joyStickId, shared::joyStickPtt)) {
+                    shared::isPttOpen = false;
+                }
+            } else {
+                if (!sf::Keyboard::isKeyPressed(shared::ptt)) {
+                    shared::isPttOpen = false;
                 }
             }
-        }
-    }
-
-    if (evt == afv_native::ClientEventType::StationTransceiversUpdated) {
-        if (data != nullptr) {
-            // We just refresh the transceiver count in our display
-            std::string station = *reinterpret_cast<std::string*>(data);
-            auto it = std::find_if(shared::FetchedStations.begin(),
-                shared::FetchedStations.end(),
-                [station](const auto& fs) { return fs.callsign == station; });
-            if (it != shared::FetchedStations.end())
-                it->transceivers
-                    = mClient_->GetTransceiverCountForStation(station);
-        }
-    }
-
-    if (evt == afv_native::ClientEventType::APIServerError) {
-        // We got an error from the API server, we can display this to the user
-        if (data != nullptr) {
-            afv_native::afv::APISessionError err
-                = *reinterpret_cast<afv_native::afv::APISessionError*>(data);
-
-            if (err == afv_native::afv::APISessionError::BadPassword
-                || err
-                    == afv_native::afv::APISessionError::RejectedCredentials) {
-                errorModal("Could not login to VATSIM.\nInvalid "
-                           "Credentials.\nCheck your password/cid!");
-
-                spdlog::error("Got invalid credential errors from AFV API: "
-                              "HTTP 403 or 401");
-            }
-
-            if (err == afv_native::afv::APISessionError::ConnectionError) {
-                errorModal("Could not login to VATSIM.\nConnection "
-                           "Error.\nCheck your internet connection.");
-
-                spdlog::error("Got connection error from AFV API: local socket "
-                              "or curl error");
-            }
-
-            if (err
-                == afv_native::afv::APISessionError::
-                    BadRequestOrClientIncompatible) {
-                errorModal("Could not login to VATSIM.\n Bad Request or Client "
-                           "Incompatible.");
-
-                spdlog::error("Got connection error from AFV API: HTTP 400 - "
-                              "Bad Request or Client Incompatible");
-            }
-
-            if (err == afv_native::afv::APISessionError::InvalidAuthToken) {
-                errorModal("Could not login to VATSIM.\n Invalid Auth Token.");
-
-                spdlog::error("Got connection error from AFV API: Invalid Auth "
-                              "Token Local Parse Error.");
-            }
-
-            if (err
-                == afv_native::afv::APISessionError::
-                    AuthTokenExpiryTimeInPast) {
-                errorModal("Could not login to VATSIM.\n Auth Token has "
-                           "expired.\n Check your system clock.");
-
-                spdlog::error("Got connection error from AFV API: Auth Token "
-                              "Expiry in the past");
-            }
-
-            if (err == afv_native::afv::APISessionError::OtherRequestError) {
-                errorModal("Could not login to VATSIM.\n Unknown Error.");
 
-                spdlog::error(
-                    "Got connection error from AFV API: Unknown Error");
+            client->SetPtt(shared::isPttOpen);
+        } else {
+            if (shared::joyStickId != -1) {
+                if (sf::Joystick::isButtonPressed(
+                        shared::joyStickId, shared::joyStickPtt)) {
+                    shared::isPttOpen = true;
+                }
+            } else {
+                if (sf::Keyboard::isKeyPressed(shared::ptt)) {
+                    shared::isPttOpen = true;
+                }
             }
-        }
-    }
-
-    if (evt == afv_native::ClientEventType::AudioError) {
-        errorModal("Error starting audio devices.\nPlease check "
-                   "your log file for details.\nCheck your audio config!");
-    }
-
-    if (evt == afv_native::ClientEventType::VoiceServerDisconnected) {
-        if (!disconnectWarningSoundAvailable_) {
-            return;
-        }
 
-        if (!manuallyDisconnected_) {
-            soundPlayer_.play();
+            client->SetPtt(shared::isPttOpen);
         }
-
-        manuallyDisconnected_ = false;
     }
 
-    if (evt == afv_native::ClientEventType::VoiceServerError) {
-        int err_code = *reinterpret_cast<int*>(data);
-        errorModal("Voice server returned error " + std::to_string(err_code)
-            + ", please check the log file.");
-    }
-
-    if (evt == afv_native::ClientEventType::VoiceServerChannelError) {
-        int err_code = *reinterpret_cast<int*>(data);
-        errorModal("Voice server returned channel error "
-            + std::to_string(err_code) + ", please check the log file.");
-    }
-
-    if (evt == afv_native::ClientEventType::StationDataReceived) {
-        if (data != nullptr && data2 != nullptr) {
-            // We just refresh the transceiver count in our display
-            bool found = *reinterpret_cast<bool*>(data);
-            if (found) {
-                auto station
-                    = *reinterpret_cast<std::pair<std::string, unsigned int>*>(
-                        data2);
-
-                station.second = util::cleanUpFrequency(station.second);
-
-                shared::StationElement el = shared::StationElement::build(
-                    station.first, station.second);
-
-                if (!frequencyExists(el.freq))
-                    shared::FetchedStations.push_back(el);
-            } else {
-                errorModal("Could not find station in database.");
-                spdlog::warn(
-                    "Station not found in AFV database through search");
-            }
-        }
+    if (shared::isPttOpen != was_ptt_open) {
+        replay::Recorder::record_ptt(shared::isPttOpen);
     }
 }
 
 // Main loop
 void App::render_frame()
 {
-    // AFV stuff
-    if (mClient_) {
-        vector_audio::shared::mPeak = mClient_->GetInputPeak();
-        vector_audio::shared::mVu = mClient_->GetInputVu();
-
-        // Set the Ptt if required, input based on event
-        if (mClient_->IsVoiceConnected()
-            && (shared::ptt != sf::Keyboard::Scan::Unknown
-                || shared::joyStickId != -1)) {
-            if (shared::isPttOpen) {
-                if (shared::joyStickId != -1) {
-                    if (!sf::Joystick::isButtonPressed(
-                            shared::joyStickId, shared::joyStickPtt)) {
-                        shared::isPttOpen = false;
-                    }
-                } else {
-                    if (!sf::Keyboard::isKeyPressed(shared::ptt)) {
-                        shared::isPttOpen = false;
-                    }
-                }
+    core_->tick();
 
-                mClient_->SetPtt(shared::isPttOpen);
-            } else {
-                if (shared::joyStickId != -1) {
-                    if (sf::Joystick::isButtonPressed(
-                            shared::joyStickId, shared::joyStickPtt)) {
-                        shared::isPttOpen = true;
-                    }
-                } else {
-                    if (sf::Keyboard::isKeyPressed(shared::ptt)) {
-                        shared::isPttOpen = true;
-                    }
-                }
-
-                mClient_->SetPtt(shared::isPttOpen);
-            }
-        }
-
-        if (mClient_->IsAPIConnected() && shared::FetchedStations.empty()
-            && !shared::bootUpVccs) {
-            // We force add the current user frequency
-            shared::bootUpVccs = true;
-
-            // We replaced double _ which may be used during frequency
-            // handovers, but are not defined in database
-            std::string clean_callsign = vector_audio::util::ReplaceString(
-                shared::session::callsign, "__", "_");
-
-            shared::StationElement el = shared::StationElement::build(
-                clean_callsign, shared::session::frequency);
-            if (!frequencyExists(el.freq))
-                shared::FetchedStations.push_back(el);
-
-            this->mClient_->AddFrequency(
-                shared::session::frequency, clean_callsign);
-            mClient_->SetEnableInputFilters(vector_audio::shared::mInputFilter);
-            mClient_->SetEnableOutputEffects(
-                vector_audio::shared::mOutputEffects);
-            this->mClient_->UseTransceiversFromStation(
-                clean_callsign, shared::session::frequency);
-            this->mClient_->SetRx(shared::session::frequency, true);
-            if (shared::session::facility > 0) {
-                this->mClient_->SetTx(shared::session::frequency, true);
-                this->mClient_->SetXc(shared::session::frequency, true);
-            }
-            this->mClient_->FetchStationVccs(clean_callsign);
-            mClient_->SetRadiosGain(shared::RadioGain / 100.0F);
-        }
+    auto* client = core_->client();
+    if (!client) {
+        return;
     }
 
-    // Forcing removal of unused stations if possible, otherwise we try at the
-    // next loop
-    shared::StationsPendingRemoval.erase(
-        std::remove_if(shared::StationsPendingRemoval.begin(),
-            shared::StationsPendingRemoval.end(),
-            [this](int const& station) {
-                // First we check if we are not receiving or transmitting
-                // on the frequency
-                if (!this->mClient_->GetRxActive(station)
-                    && !this->mClient_->GetTxActive(station)) {
-                    // The frequency is free, we can remove it
-
-                    shared::FetchedStations.erase(
-                        std::remove_if(shared::FetchedStations.begin(),
-                            shared::FetchedStations.end(),
-                            [station](shared::StationElement const& p) {
-                                return station == p.freq;
-                            }),
-                        shared::FetchedStations.end());
-                    mClient_->RemoveFrequency(station);
-
-                    return true;
-                } // The frequency is not free, we try again later
-                return false;
-            }),
-        shared::StationsPendingRemoval.end());
-
-    // Changing RX status that is locked
-    shared::StationsPendingRxChange.erase(
-        std::remove_if(shared::StationsPendingRxChange.begin(),
-            shared::StationsPendingRxChange.end(),
-            [this](int const& station) {
-                if (!this->mClient_->GetRxActive(station)) {
-                    // Frequency is free, we can change the state
-                    this->mClient_->SetRx(
-                        station, !this->mClient_->GetRxState(station));
-                    return true;
-                } // Frequency is not free, we try again later
-                return false;
-            }),
-        shared::StationsPendingRxChange.end());
-
-    // The live Received callsign data
-    std::vector<std::string> received_callsigns;
-    std::vector<std::string> live_received_callsigns;
+    pollPtt();
 
     ImGui::SetNextWindowPos(ImVec2(0.0F, 0.0F));
     ImGui::SetNextWindowSize(ImGui::GetIO().DisplaySize);
@@ -562,97 +119,15 @@ void App::render_frame()
 
     // Connect button logic
 
-    if (!mClient_->IsVoiceConnected() && !mClient_->IsAPIConnected()) {
+    if (!core_->isConnected()) {
+        auto* data_handler = core_->dataHandler();
         bool ready_to_connect = (!shared::session::is_connected
-                                    && dataHandler_->isSlurperAvailable())
+                                    && data_handler->isSlurperAvailable())
             || shared::session::is_connected;
         style::push_disabled_on(!ready_to_connect);
 
         if (ImGui::Button("Connect")) {
-
-            if (!vector_audio::shared::session::is_connected
-                && dataHandler_->isSlurperAvailable()) {
-                // We manually call the slurper here in case that we do not have
-                // a connection yet Although this will block the whole program,
-                // it is not an issue in this case As the user does not need to
-                // interact with the software while we attempt A connection that
-                // fails once will not be retried and will default to datafile
-                // only
-
-                vector_audio::shared::session::is_connected
-                    = dataHandler_->getConnectionStatusWithSlurper();
-            }
-
-            if (vector_audio::shared::session::is_connected) {
-                if (mClient_->IsAudioRunning()) {
-                    mClient_->StopAudio();
-                }
-                if (mClient_->IsAPIConnected()) {
-                    mClient_->Disconnect(); // Force a disconnect of API
-                }
-
-                mClient_->SetAudioApi(findAudioAPIorDefault());
-                mClient_->SetAudioInputDevice(
-                    findHeadsetInputDeviceOrDefault());
-                mClient_->SetAudioOutputDevice(
-                    findHeadsetOutputDeviceOrDefault());
-                mClient_->SetAudioSpeakersOutputDevice(
-                    findSpeakerOutputDeviceOrDefault());
-                mClient_->SetHardware(vector_audio::shared::hardware);
-                mClient_->SetHeadsetOutputChannel(
-                    vector_audio::shared::headsetOutputChannel);
-
-                if (!dataHandler_->isSlurperAvailable()) {
-                    std::string client_icao
-                        = vector_audio::shared::session::callsign.substr(0,
-                            vector_audio::shared::session::callsign.find('_'));
-                    // We use the airport database for this
-                    if (ns::Airport::All.find(client_icao)
-                        != ns::Airport::All.end()) {
-                        auto client_airport = ns::Airport::All.at(client_icao);
-
-                        // We pad the elevation by 10 meters to simulate the
-                        // client being in a tower
-                        mClient_->SetClientPosition(client_airport.lat,
-                            client_airport.lon, client_airport.elevation + 33,
-                            client_airport.elevation + 33);
-
-                        spdlog::info("Found client position in database at "
-                                     "lat:{}, lon:{}, elev:{}",
-                            client_airport.lat, client_airport.lon,
-                            client_airport.elevation);
-                    } else {
-                        spdlog::warn(
-                            "Client position is unknown, setting default.");
-
-                        // Default position is over Paris somewhere
-                        mClient_->SetClientPosition(
-                            48.967860, 2.442000, 300, 300);
-                    }
-                } else {
-                    spdlog::info(
-                        "Found client position from slurper at lat:{}, lon:{}",
-                        vector_audio::shared::session::latitude,
-                        vector_audio::shared::session::longitude);
-                    mClient_->SetClientPosition(
-                        vector_audio::shared::session::latitude,
-                        vector_audio::shared::session::longitude, 300, 300);
-                }
-
-                mClient_->SetCredentials(
-                    std::to_string(vector_audio::shared::vatsim_cid),
-                    vector_audio::shared::vatsim_password);
-                mClient_->SetCallsign(vector_audio::shared::session::callsign);
-                mClient_->SetRadiosGain(shared::RadioGain / 100.0F);
-                mClient_->StartAudio();
-                if (!mClient_->Connect()) {
-                    mClient_->StopAudio();
-                    spdlog::error(
-                        "Failed to connect: afv_lib says API is connected.");
-                };
-            } else {
-                errorModal("Not connected to VATSIM!");
-            }
+            core_->connect();
         }
         style::pop_disabled_on(!ready_to_connect);
     } else {
@@ -663,24 +138,8 @@ void App::render_frame()
         ImGui::PushStyleColor(
             ImGuiCol_ButtonActive, ImColor::HSV(4 / 7.0F, 0.8F, 0.8F).Value);
 
-        // Auto disconnect if we need
-        auto pressed_disconnect = ImGui::Button("Disconnect");
-        if (pressed_disconnect || !shared::session::is_connected) {
-
-            if (pressed_disconnect) {
-                manuallyDisconnected_ = true;
-            }
-
-            if (mClient_->IsAtisPlayingBack())
-                mClient_->StopAtisPlayback();
-
-            // Cleanup everything
-            for (const auto& f : shared::FetchedStations)
-                mClient_->RemoveFrequency(f.freq);
-            mClient_->Disconnect();
-
-            shared::FetchedStations.clear();
-            shared::bootUpVccs = false;
+        if (ImGui::Button("Disconnect")) {
+            core_->disconnect(true);
         }
         ImGui::PopStyleColor(3);
     }
@@ -688,19 +147,18 @@ void App::render_frame()
     ImGui::SameLine();
 
     // Settings modal
-    style::push_disabled_on(mClient_->IsAPIConnected());
-    if (ImGui::Button("Settings") && !mClient_->IsAPIConnected()) {
-        // Update all available data
-        vector_audio::shared::availableAudioAPI = mClient_->GetAudioApis();
-        vector_audio::shared::availableInputDevices
-            = mClient_->GetAudioInputDevices(vector_audio::shared::mAudioApi);
-        vector_audio::shared::availableOutputDevices
-            = mClient_->GetAudioOutputDevices(vector_audio::shared::mAudioApi);
+    style::push_disabled_on(client->IsAPIConnected());
+    if (ImGui::Button("Settings") && !client->IsAPIConnected()) {
+        // Update all available data, the lists fill in once this is done
+        if (core_->audioDevices()) {
+            core_->audioDevices()->refresh(
+                vector_audio::shared::configAudioApi);
+        }
         ImGui::OpenPopup("Settings Panel");
     }
-    style::pop_disabled_on(mClient_->IsAPIConnected());
+    style::pop_disabled_on(client->IsAPIConnected());
 
-    vector_audio::modals::Settings::render(mClient_);
+    vector_audio::modals::Settings::render(client, core_->audioDevices());
 
     {
         ImGui::SetNextWindowSize(ImVec2(300, -1));
@@ -722,22 +180,22 @@ void App::render_frame()
     const ImVec4 red(1.0, 0.0, 0.0, 1.0);
     const ImVec4 yellow(1.0, 1.0, 0.0, 1.0);
     const ImVec4 green(0.0, 1.0, 0.0, 1.0);
-    ImGui::TextColored(mClient_->IsAPIConnected() ? green : red, "API");
+    ImGui::TextColored(client->IsAPIConnected() ? green : red, "API");
     ImGui::SameLine();
     ImGui::Text("|");
     ImGui::SameLine();
-    ImGui::TextColored(mClient_->IsVoiceConnected() ? green : red, "Voice");
+    ImGui::TextColored(client->IsVoiceConnected() ? green : red, "Voice");
     ImGui::SameLine();
     ImGui::Text("|");
     ImGui::SameLine();
     // Status about datasource
 
-    if (dataHandler_->isSlurperAvailable()) {
+    if (core_->dataHandler()->isSlurperAvailable()) {
         ImGui::TextColored(green, "Slurper");
         /*if (ImGui::IsItemClicked()) {
             shared::slurper::is_unavailable = true;
         }*/
-    } else if (dataHandler_->isDatafileAvailable()) {
+    } else if (core_->dataHandler()->isDatafileAvailable()) {
         ImGui::TextColored(yellow, "Datafile");
     } else {
         ImGui::TextColored(red, "No VATSIM Data");
@@ -757,6 +215,7 @@ void App::render_frame()
     // Main area
     //
 
+    Profiler::Scope table_scope("Station table");
     ImGui::BeginGroup();
     ImGuiTableFlags flags = ImGuiTableFlags_BordersOuter
         | ImGuiTableFlags_BordersV | ImGuiTableFlags_NoBordersInBody
@@ -782,13 +241,13 @@ void App::render_frame()
             ImGui::PushStyleColor(ImGuiCol_Button, ImColor(14, 17, 22).Value);
 
             // Polling all data
-            bool freq_active = mClient_->IsFrequencyActive(el.freq);
-            bool rx_state = mClient_->GetRxState(el.freq);
-            bool rx_active = mClient_->GetRxActive(el.freq);
-            bool tx_state = mClient_->GetTxState(el.freq);
-            bool tx_active = mClient_->GetTxActive(el.freq);
-            bool xc_state = mClient_->GetXcState(el.freq);
-            bool is_on_speaker = !mClient_->GetOnHeadset(el.freq);
+            bool freq_active = client->IsFrequencyActive(el.freq);
+            bool rx_state = client->GetRxState(el.freq);
+            bool rx_active = client->GetRxActive(el.freq);
+            bool tx_state = client->GetTxState(el.freq);
+            bool tx_active = client->GetTxActive(el.freq);
+            bool xc_state = client->GetXcState(el.freq);
+            bool is_on_speaker = !client->GetOnHeadset(el.freq);
 
             //
             // Frequency button
@@ -819,7 +278,7 @@ void App::render_frame()
                 if (ImGui::Selectable(std::string("Force Refresh##")
                                           .append(el.callsign)
                                           .c_str())) {
-                    mClient_->FetchTransceiverInfo(el.callsign);
+                    client->FetchTransceiverInfo(el.callsign);
                 }
                 if (ImGui::Selectable(
                         std::string("Delete##").append(el.callsign).c_str())) {
@@ -838,23 +297,6 @@ void App::render_frame()
                 // Set button colour
                 rx_active ? vector_audio::style::button_yellow()
                           : vector_audio::style::button_green();
-
-                auto received_cld = mClient_->LastTransmitOnFreq(el.freq);
-                if (!received_cld.empty()
-                    && std::find(received_callsigns.begin(),
-                           received_callsigns.end(), received_cld)
-                        == received_callsigns.end()) {
-                    received_callsigns.push_back(received_cld);
-                }
-
-                // Here we filter not the last callsigns that transmitted, but
-                // only the ones that are currently transmitting
-                if (rx_active && !received_cld.empty()
-                    && std::find(live_received_callsigns.begin(),
-                           live_received_callsigns.end(), received_cld)
-                        == live_received_callsigns.end()) {
-                    live_received_callsigns.push_back(received_cld);
-                }
             }
 
             if (ImGui::Button(std::string("RX##").append(el.callsign).c_str(),
@@ -869,17 +311,17 @@ void App::render_frame()
                             == shared::StationsPendingRxChange.end())
                             shared::StationsPendingRxChange.push_back(el.freq);
                     } else {
-                        mClient_->SetRx(el.freq, !rx_state);
+                        client->SetRx(el.freq, !rx_state);
                     }
                 } else {
-                    mClient_->AddFrequency(el.freq, el.callsign);
-                    mClient_->SetEnableInputFilters(
+                    client->AddFrequency(el.freq, el.callsign);
+                    client->SetEnableInputFilters(
                         vector_audio::shared::mInputFilter);
-                    mClient_->SetEnableOutputEffects(
+                    client->SetEnableOutputEffects(
                         vector_audio::shared::mOutputEffects);
-                    mClient_->UseTransceiversFromStation(el.callsign, el.freq);
-                    mClient_->SetRx(el.freq, true);
-                    mClient_->SetRadiosGain(shared::RadioGain / 100.0F);
+                    client->UseTransceiversFromStation(el.callsign, el.freq);
+                    client->SetRx(el.freq, true);
+                    client->SetRadiosGain(shared::RadioGain / 100.0F);
                 }
             }
 
@@ -901,18 +343,18 @@ void App::render_frame()
                     quarter_size)
                 && shared::session::facility > 0) {
                 if (freq_active) {
-                    mClient_->SetXc(el.freq, !xc_state);
+                    client->SetXc(el.freq, !xc_state);
                 } else {
-                    mClient_->AddFrequency(el.freq, el.callsign);
-                    mClient_->SetEnableInputFilters(
+                    client->AddFrequency(el.freq, el.callsign);
+                    client->SetEnableInputFilters(
                         vector_audio::shared::mInputFilter);
-                    mClient_->SetEnableOutputEffects(
+                    client->SetEnableOutputEffects(
                         vector_audio::shared::mOutputEffects);
-                    mClient_->UseTransceiversFromStation(el.callsign, el.freq);
-                    mClient_->SetTx(el.freq, true);
-                    mClient_->SetRx(el.freq, true);
-                    mClient_->SetXc(el.freq, true);
-                    mClient_->SetRadiosGain(shared::RadioGain / 100.0F);
+                    client->UseTransceiversFromStation(el.callsign, el.freq);
+                    client->SetTx(el.freq, true);
+                    client->SetRx(el.freq, true);
+                    client->SetXc(el.freq, true);
+                    client->SetRadiosGain(shared::RadioGain / 100.0F);
                 }
             }
 
@@ -939,7 +381,7 @@ void App::render_frame()
             speaker_string.append(el.callsign);
             if (ImGui::Button(speaker_string.c_str(), quarter_size)) {
                 if (freq_active)
-                    mClient_->SetOnHeadset(el.freq, is_on_speaker);
+                    client->SetOnHeadset(el.freq, is_on_speaker);
             }
 
             if (is_on_speaker)
@@ -959,17 +401,17 @@ void App::render_frame()
                     std::string("TX##").append(el.callsign).c_str(), half_size)
                 && shared::session::facility > 0) {
                 if (freq_active) {
-                    mClient_->SetTx(el.freq, !tx_state);
+                    client->SetTx(el.freq, !tx_state);
                 } else {
-                    mClient_->AddFrequency(el.freq, el.callsign);
-                    mClient_->SetEnableInputFilters(
+                    client->AddFrequency(el.freq, el.callsign);
+                    client->SetEnableInputFilters(
                         vector_audio::shared::mInputFilter);
-                    mClient_->SetEnableOutputEffects(
+                    client->SetEnableOutputEffects(
                         vector_audio::shared::mOutputEffects);
-                    mClient_->UseTransceiversFromStation(el.callsign, el.freq);
-                    mClient_->SetTx(el.freq, true);
-                    mClient_->SetRx(el.freq, true);
-                    mClient_->SetRadiosGain(shared::RadioGain / 100.0F);
+                    client->UseTransceiversFromStation(el.callsign, el.freq);
+                    client->SetTx(el.freq, true);
+                    client->SetRx(el.freq, true);
+                    client->SetRadiosGain(shared::RadioGain / 100.0F);
                 }
             }
 
@@ -985,6 +427,7 @@ void App::render_frame()
         ImGui::EndTable();
     }
     ImGui::EndGroup();
+    table_scope.end();
 
     //
     // Side pannel settings
@@ -997,56 +440,19 @@ void App::render_frame()
     ImGui::PushItemWidth(-1.0);
     ImGui::Text("Add station");
 
-    style::push_disabled_on(!mClient_->IsVoiceConnected());
+    style::push_disabled_on(!client->IsVoiceConnected());
     if (ImGui::InputText("Callsign##Auto", &shared::station_auto_add_callsign,
             ImGuiInputTextFlags_EnterReturnsTrue
                 | ImGuiInputTextFlags_AutoSelectAll
                 | ImGuiInputTextFlags_CharsUppercase)
         || ImGui::Button("Add", ImVec2(-FLT_MIN, 0.0))) {
-        if (mClient_->IsVoiceConnected()) {
-            if (!util::startsWith(shared::station_auto_add_callsign, "!")) {
-                mClient_->GetStation(shared::station_auto_add_callsign);
-                mClient_->FetchStationVccs(shared::station_auto_add_callsign);
-            } else {
-                double latitude;
-                double longitude;
-                shared::station_auto_add_callsign
-                    = shared::station_auto_add_callsign.substr(1);
-
-                if (!frequencyExists(shared::kUnicomFrequency)) {
-                    if (dataHandler_->getPilotPositionWithAnything(
-                            shared::station_auto_add_callsign, latitude,
-                            longitude)) {
-
-                        shared::StationElement el
-                            = shared::StationElement::build(
-                                shared::station_auto_add_callsign,
-                                shared::kUnicomFrequency);
-
-                        shared::FetchedStations.push_back(el);
-                        mClient_->SetClientPosition(
-                            latitude, longitude, 1000, 1000);
-                        mClient_->AddFrequency(shared::kUnicomFrequency,
-                            shared::station_auto_add_callsign);
-                        mClient_->SetRx(shared::kUnicomFrequency, true);
-                        mClient_->SetRadiosGain(shared::RadioGain / 100.0F);
-
-                    } else {
-                        errorModal("Could not find pilot connected under that "
-                                   "callsign.");
-                    }
-
-                } else {
-                    errorModal("Another UNICOM frequency is active, please "
-                               "delete it first.");
-                }
-            }
-
+        if (client->IsVoiceConnected()) {
+            core_->addStation(shared::station_auto_add_callsign);
             shared::station_auto_add_callsign = "";
         }
     }
     ImGui::PopItemWidth();
-    style::pop_disabled_on(!mClient_->IsVoiceConnected());
+    style::pop_disabled_on(!client->IsVoiceConnected());
 
     ImGui::NewLine();
 
@@ -1054,23 +460,26 @@ void App::render_frame()
 
     ImGui::PushItemWidth(-1.0);
     ImGui::Text("Radio Gain");
-    style::push_disabled_on(!mClient_->IsVoiceConnected());
+    style::push_disabled_on(!client->IsVoiceConnected());
     if (ImGui::SliderInt(
             "##Radio Gain", &shared::RadioGain, 0, 200, "%.3i %%")) {
-        if (mClient_->IsVoiceConnected())
-            mClient_->SetRadiosGain(shared::RadioGain / 100.0F);
+        if (client->IsVoiceConnected())
+            client->SetRadiosGain(shared::RadioGain / 100.0F);
     }
     ImGui::PopItemWidth();
-    style::pop_disabled_on(!mClient_->IsVoiceConnected());
+    style::pop_disabled_on(!client->IsVoiceConnected());
 
     ImGui::NewLine();
 
+    const auto& received_callsigns = core_->receivedCallsigns();
     std::string rx_list = "Last RX: ";
     rx_list.append(received_callsigns.empty()
             ? ""
             : std::accumulate(++received_callsigns.begin(),
                 received_callsigns.end(), *received_callsigns.begin(),
-                [](auto& a, auto& b) { return a + ", " + b; }));
+                [](const auto& a, const auto& b) {
+                    return a + ", " + b;
+                }));
     ImGui::PushItemWidth(-1.0);
     ImGui::TextWrapped("%s", rx_list.c_str());
     ImGui::PopItemWidth();
@@ -1093,26 +502,6 @@ void App::render_frame()
         showErrorModal_ = false;
     }
 
-    // Clear out the old API data every 500ms
-    auto current_time = std::chrono::high_resolution_clock::now();
-    if (std::chrono::duration_cast<std::chrono::milliseconds>(
-            current_time - shared::currentlyTransmittingApiTimer)
-            .count()
-        >= 300) {
-        const std::lock_guard<std::mutex> lock(
-            vector_audio::shared::transmitting_mutex);
-        shared::currentlyTransmittingApiData = "";
-
-        shared::currentlyTransmittingApiData.append(
-            live_received_callsigns.empty()
-                ? ""
-                : std::accumulate(++live_received_callsigns.begin(),
-                    live_received_callsigns.end(),
-                    *live_received_callsigns.begin(),
-                    [](auto& a, auto& b) { return a + "," + b; }));
-        shared::currentlyTransmittingApiTimer = current_time;
-    }
-
     ImGui::End();
 }
 
@@ -1121,12 +510,4 @@ void App::errorModal(std::string message)
     this->showErrorModal_ = true;
     lastErrorModalMessage_ = std::move(message);
 }
-
-bool App::frequencyExists(int freq)
-{
-    return std::find_if(shared::FetchedStations.begin(),
-               shared::FetchedStations.end(),
-               [&freq](const auto& obj) { return obj.freq == freq; })
-        != shared::FetchedStations.end();
-}
 } // namespace vector_audio::application
\ No newline at end of file
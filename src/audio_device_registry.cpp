@@ -0,0 +1,135 @@
+#include "audio_device_registry.h"
+#include <spdlog/spdlog.h>
+
+namespace vector_audio {
+
+AudioDeviceRegistry::AudioDeviceRegistry(
+    AfvClient* client, ClientFactory make_enumerator)
+    : client_(client)
+    , make_enumerator_(std::move(make_enumerator))
+    , api_name_(shared::configAudioApi)
+{
+    worker_ = std::thread(&AudioDeviceRegistry::worker, this);
+}
+
+AudioDeviceRegistry::~AudioDeviceRegistry()
+{
+    {
+        const std::lock_guard<std::mutex> lk(m_);
+        keep_running_ = false;
+    }
+    cv_.notify_one();
+
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void AudioDeviceRegistry::refresh(const std::string& api_name)
+{
+    {
+        const std::lock_guard<std::mutex> lk(m_);
+        api_name_ = api_name;
+        refresh_requested_ = true;
+    }
+    cv_.notify_one();
+}
+
+bool AudioDeviceRegistry::update()
+{
+    audio_running_ = client_->IsAudioRunning();
+
+    const std::lock_guard<std::mutex> lk(m_);
+    if (!has_update_) {
+        return false;
+    }
+
+    shared::availableAudioAPI = latest_.apis;
+    shared::availableInputDevices = latest_.inputs;
+    shared::availableOutputDevices = latest_.outputs;
+
+    // Only a refresh someone asked for selects the API, the timer would
+    // otherwise undo a selection made since
+    if (api_requested_) {
+        shared::mAudioApi = latest_.api;
+    }
+
+    has_update_ = false;
+    api_requested_ = false;
+    return true;
+}
+
+AudioDeviceRegistry::Devices AudioDeviceRegistry::enumerate(
+    AfvClient& client, const std::string& api_name)
+{
+    Devices devices;
+    devices.apis = client.GetAudioApis();
+
+    // Anything we do not know of, including "Default API", maps to the default
+    for (const auto& api : devices.apis) {
+        if (api.second == api_name)
+            devices.api = api.first;
+    }
+
+    devices.inputs = client.GetAudioInputDevices(devices.api);
+    devices.outputs = client.GetAudioOutputDevices(devices.api);
+
+    return devices;
+}
+
+void AudioDeviceRegistry::worker()
+{
+    std::unique_ptr<AfvClient> own_client;
+    AfvClient* enumerator = client_;
+    if (make_enumerator_) {
+        try {
+            own_client = make_enumerator_();
+            enumerator = own_client.get();
+        } catch (std::exception& ex) {
+            spdlog::error(
+                "Could not create the audio device client: {}", ex.what());
+            return;
+        }
+    }
+
+    std::unique_lock<std::mutex> lk(m_);
+    while (keep_running_) {
+        if (refresh_requested_ || !audio_running_) {
+            auto api_name = api_name_;
+            bool requested = refresh_requested_;
+            refresh_requested_ = false;
+
+            lk.unlock();
+            Devices devices;
+            bool enumerated = true;
+            try {
+                devices = enumerate(*enumerator, api_name);
+            } catch (std::exception& ex) {
+                spdlog::error(
+                    "Could not enumerate audio devices: {}", ex.what());
+                enumerated = false;
+            }
+            lk.lock();
+
+            bool changed = enumerated
+                && (devices.apis != latest_.apis
+                    || devices.inputs != latest_.inputs
+                    || devices.outputs != latest_.outputs);
+
+            if (changed && !requested) {
+                spdlog::info("Audio devices changed, refreshing device list");
+            }
+
+            if (enumerated && (changed || requested)) {
+                latest_ = std::move(devices);
+                has_update_ = true;
+                api_requested_ = api_requested_ || requested;
+            }
+        }
+
+        cv_.wait_for(lk, kRefreshInterval,
+            [this] { return !keep_running_ || refresh_requested_; });
+    }
+}
+
+}
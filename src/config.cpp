@@ -1,5 +1,11 @@
 #include "config.h"
+#include "shared.h"
 #include <filesystem>
+#include <algorithm>
+#include <cctype>
+#include <functional>
+#include <string_view>
+#include <vector>
 
 #ifdef SFML_SYSTEM_MACOS
 #include "osx_resources.h"
@@ -18,6 +24,181 @@
 namespace vector_audio {
 toml::value Configuration::config_;
 
+namespace {
+    // A setting in config.toml, bound to the variable that holds it at runtime
+    struct ConfigField {
+        std::string section;
+        std::string key;
+
+        // Returns false if the stored value does not pass validation
+        std::function<bool(const toml::value&)> load;
+        std::function<void()> reset;
+        std::function<toml::value()> get;
+    };
+
+    // Stored is the type in the file, T the type of the variable, which may be
+    // an enum stored as an integer
+    template <typename Stored, typename T>
+    ConfigField field(const char* section, const char* key, T& target,
+        T default_value, std::function<bool(const Stored&)> validate = nullptr)
+    {
+        ConfigField f;
+        f.section = section;
+        f.key = key;
+        f.load = [&target, validate](const toml::value& value) {
+            auto stored = toml::get<Stored>(value);
+            if (validate && !validate(stored)) {
+                return false;
+            }
+            target = static_cast<T>(stored);
+            return true;
+        };
+        f.reset = [&target, default_value]() { target = default_value; };
+        f.get = [&target]() { return toml::value(static_cast<Stored>(target)); };
+        return f;
+    }
+
+    bool isLogLevel(const std::string& name)
+    {
+        return name == "off" || spdlog::level::from_str(name) != spdlog::level::off;
+    }
+
+    const std::vector<ConfigField>& schema()
+    {
+        using namespace vector_audio::shared;
+
+        static const std::vector<ConfigField> fields = {
+            field<int>("general", "api_port", apiServerPort, 49080,
+                [](const int& port) { return port > 0 && port < 65536; }),
+            field<std::string>("general", "api_socket", apiServerSocket, std::string("")),
+
+            field<int>("user", "vatsim_id", vatsim_cid, 999999),
+            field<std::string>("user", "vatsim_password", vatsim_password, std::string("password")),
+            field<bool>("user", "keepWindowOnTop", keepWindowOnTop, false),
+            field<int>("user", "ptt", ptt, sf::Keyboard::Scan::Unknown),
+            field<int>("user", "joyStickId", joyStickId, -1),
+            field<int>("user", "joyStickPtt", joyStickPtt, -1),
+
+            field<bool>("audio", "vhf_effects", mOutputEffects, true),
+            field<bool>("audio", "input_filters", mInputFilter, true),
+            field<std::string>("audio", "api", configAudioApi, std::string("Default API")),
+            field<std::string>("audio", "input_device", configInputDeviceName, std::string("")),
+            field<std::string>("audio", "output_device", configOutputDeviceName, std::string("")),
+            field<std::string>("audio", "speaker_device", configSpeakerDeviceName, std::string("")),
+            field<int>("audio", "headset_channel", headsetOutputChannel, 0,
+                [](const int& channel) { return channel >= 0 && channel <= 2; }),
+            field<int>("audio", "hardware_type", hardware, afv_native::HardwareType::Schmid_ED_137B,
+                [](const int& type) { return type >= 0 && type < static_cast<int>(AvailableHardware.size()); }),
+
+            field<std::string>("updater", "last_version", lastSeenVersion, std::string("")),
+
+            field<std::string>("log", "level", logLevel, std::string(kDefaultLogLevel), isLogLevel),
+            field<std::string>("log", "afv_level", afvLogLevel, std::string(kDefaultLogLevel), isLogLevel),
+            field<int>("log", "flush_interval", logFlushInterval, 5,
+                [](const int& seconds) { return seconds > 0; }),
+            field<bool>("log", "afv_json", afvJsonLog, false),
+        };
+
+        return fields;
+    }
+}
+
+void Configuration::load_settings()
+{
+    const toml::table* root = config_.is_table() ? &config_.as_table() : nullptr;
+
+    for (const auto& f : schema()) {
+        f.reset();
+        if (!root) {
+            continue;
+        }
+
+        auto section = root->find(f.section);
+        if (section == root->end() || !section->second.is_table()) {
+            continue;
+        }
+
+        auto value = section->second.as_table().find(f.key);
+        if (value == section->second.as_table().end()) {
+            continue;
+        }
+
+        try {
+            if (!f.load(value->second)) {
+                spdlog::warn("Invalid value for {}.{} in config, using the default", f.section, f.key);
+                f.reset();
+            }
+        } catch (toml::exception&) {
+            spdlog::warn("Wrong type for {}.{} in config, using the default", f.section, f.key);
+            f.reset();
+        }
+    }
+
+    if (!root) {
+        return;
+    }
+
+    // Anything we do not know of is most likely a typo, which would otherwise
+    // silently fall back to the default
+    for (const auto& [section_name, section] : *root) {
+        if (!section.is_table()) {
+            spdlog::warn("Unknown config key {}, it will be ignored", section_name);
+            continue;
+        }
+
+        for (const auto& [key, value] : section.as_table()) {
+            auto known = std::any_of(schema().begin(), schema().end(), [&](const ConfigField& f) {
+                return f.section == section_name && f.key == key;
+            });
+
+            if (!known) {
+                spdlog::warn("Unknown config key {}.{}, it will be ignored", section_name, key);
+            }
+        }
+    }
+}
+
+bool Configuration::save_settings()
+{
+    bool changed = false;
+    for (const auto& f : schema()) {
+        auto value = f.get();
+        auto& stored = config_[f.section][f.key];
+        if (stored != value) {
+            stored = std::move(value);
+            changed = true;
+        }
+    }
+
+    if (changed) {
+        write_config_async();
+    }
+
+    return changed;
+}
+
+bool Configuration::save_setting(const std::string& section, const std::string& key)
+{
+    auto f = std::find_if(schema().begin(), schema().end(), [&](const ConfigField& field) {
+        return field.section == section && field.key == key;
+    });
+
+    if (f == schema().end()) {
+        spdlog::error("Cannot save unknown setting {}.{}", section, key);
+        return false;
+    }
+
+    auto value = f->get();
+    auto& stored = config_[f->section][f->key];
+    if (stored == value) {
+        return false;
+    }
+
+    stored = std::move(value);
+    write_config_async();
+    return true;
+}
+
 void Configuration::build_config()
 {
     const auto config_file_path = Configuration::get_config_folder_path() / std::filesystem::path(config_file_name_);
@@ -25,10 +206,17 @@ void Configuration::build_config()
     airports_db_file_path_ = (get_resource_folder() / std::filesystem::path(airports_db_file_path_)).string();
 
     if (std::filesystem::exists(config_file_path)) {
-        vector_audio::Configuration::config_ = toml::parse(config_file_path);
+        try {
+            vector_audio::Configuration::config_ = toml::parse(config_file_path);
+        } catch (toml::exception& exc) {
+            spdlog::error("Failed to parse available configuration: {}", exc.what());
+        }
     } else {
         spdlog::info("Did not find a config file, starting from scratch.");
     }
+
+    load_settings();
+    apply_log_settings();
 }
 
 std::filesystem::path Configuration::get_resource_folder()
@@ -73,12 +261,96 @@ std::string Configuration::get_linux_config_folder()
 
 void Configuration::write_config_async()
 {
-    std::thread([]() {
-        const std::lock_guard<std::mutex> lock(vector_audio::Configuration::config_writer_lock_);
-        std::ofstream ofs(Configuration::get_config_folder_path() / std::filesystem::path(config_file_name_));
-        ofs << vector_audio::Configuration::config_;
+    // The config is snapshotted here, on the thread that changed it, so the
+    // writer never reads it while it is being modified
+    const std::lock_guard<std::mutex> lock(config_writer_lock_);
+    pending_config_ = config_;
+    pending_generation_++;
+
+    if (!config_writer_thread_) {
+        config_writer_running_ = true;
+        config_writer_thread_ = std::make_unique<std::thread>(&Configuration::config_writer);
+    }
+
+    config_writer_cv_.notify_one();
+}
+
+void Configuration::stop_config_writer()
+{
+    {
+        const std::lock_guard<std::mutex> lock(config_writer_lock_);
+        config_writer_running_ = false;
+    }
+    config_writer_cv_.notify_one();
+
+    if (config_writer_thread_ && config_writer_thread_->joinable())
+        config_writer_thread_->join();
+    config_writer_thread_.reset();
+}
+
+void Configuration::config_writer()
+{
+    std::unique_lock<std::mutex> lock(config_writer_lock_);
+    while (true) {
+        config_writer_cv_.wait(lock, [] { return pending_config_.has_value() || !config_writer_running_; });
+
+        if (!pending_config_) {
+            break;
+        }
+
+        // Coalesce bursts of writes, we only write once nothing new came in
+        // for a little while, when stopping, or once the first change waited
+        // long enough
+        auto deadline = std::chrono::steady_clock::now() + kConfigWriteMaxDelay;
+        auto generation = pending_generation_;
+        while (config_writer_running_) {
+            auto quiet = std::min(std::chrono::steady_clock::now() + kConfigWriteDelay, deadline);
+            if (!config_writer_cv_.wait_until(lock, quiet, [&generation] { return pending_generation_ != generation || !config_writer_running_; })) {
+                break;
+            }
+            generation = pending_generation_;
+        }
+
+        auto config = std::move(*pending_config_);
+        pending_config_.reset();
+
+        lock.unlock();
+        write_config_file(config);
+        lock.lock();
+        config_file_writes_++;
+    }
+}
+
+unsigned int Configuration::config_file_writes()
+{
+    const std::lock_guard<std::mutex> lock(config_writer_lock_);
+    return config_file_writes_;
+}
+
+void Configuration::write_config_file(const toml::value& config)
+{
+    // We write to a temporary file first, so that a crash or a full disk
+    // never leaves a truncated config behind
+    const auto config_file_path = Configuration::get_config_folder_path() / std::filesystem::path(config_file_name_);
+    auto temp_file_path = config_file_path;
+    temp_file_path += ".tmp";
+
+    {
+        std::ofstream ofs(temp_file_path, std::ios::trunc);
+        ofs << config;
         ofs.close();
-    }).detach();
+
+        if (!ofs) {
+            spdlog::error("Could not write config file to {}", temp_file_path.string());
+            return;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(temp_file_path, config_file_path, ec);
+    if (ec) {
+        spdlog::error("Could not replace config file: {}", ec.message());
+    }
 }
 
 void Configuration::build_logger()
@@ -91,16 +363,99 @@ void Configuration::build_logger()
         log_folder.string(),
         1024 * 1024 * 10, 3);
 
-#ifdef NDEBUG
-    spdlog::set_level(spdlog::level::info);
-#else
-    spdlog::set_level(spdlog::level::trace);
-#endif
+    spdlog::set_level(spdlog::level::from_str(kDefaultLogLevel));
 
-    spdlog::flush_on(spdlog::level::info);
+    // Flushing on every info line makes the logging thread hit the disk for
+    // every message, so we only flush right away for problems and batch the
+    // rest
+    spdlog::flush_on(spdlog::level::warn);
     spdlog::set_default_logger(async_rotating_file_logger);
 }
 
+namespace {
+    // Writes the message as a JSON string body, for the JSON lines log
+    class JsonEscapedMessage : public spdlog::custom_flag_formatter {
+    public:
+        void format(const spdlog::details::log_msg& msg, const std::tm& /*tm_time*/, spdlog::memory_buf_t& dest) override
+        {
+            static const char* hex = "0123456789abcdef";
+
+            for (auto c : std::string_view(msg.payload.data(), msg.payload.size())) {
+                switch (c) {
+                case '"':
+                    dest.append(std::string_view("\\\""));
+                    break;
+                case '\\':
+                    dest.append(std::string_view("\\\\"));
+                    break;
+                case '\n':
+                    dest.append(std::string_view("\\n"));
+                    break;
+                case '\r':
+                    dest.append(std::string_view("\\r"));
+                    break;
+                case '\t':
+                    dest.append(std::string_view("\\t"));
+                    break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        const char escaped[] = { '\\', 'u', '0', '0', hex[(c >> 4) & 0xF], hex[c & 0xF] };
+                        dest.append(escaped, escaped + sizeof(escaped));
+                    } else {
+                        dest.push_back(c);
+                    }
+                }
+            }
+        }
+
+        std::unique_ptr<custom_flag_formatter> clone() const override
+        {
+            return std::make_unique<JsonEscapedMessage>();
+        }
+    };
+}
+
+void Configuration::apply_log_settings()
+{
+    spdlog::flush_every(std::chrono::seconds(shared::logFlushInterval));
+
+    // afv-native gets its own logger, sharing our sinks, so that its level can
+    // be set separately as it is by far the most verbose
+    auto main_logger = spdlog::default_logger();
+    std::vector<spdlog::sink_ptr> sinks(main_logger->sinks().begin(), main_logger->sinks().end());
+
+    if (shared::afvJsonLog) {
+        auto json_log_path = Configuration::get_config_folder_path() / std::filesystem::path("afv_native.jsonl");
+        auto json_sink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(json_log_path.string(), 1024 * 1024 * 50, 3);
+
+        auto formatter = std::make_unique<spdlog::pattern_formatter>();
+        formatter->add_flag<JsonEscapedMessage>('*').set_pattern(
+            R"({"time":"%Y-%m-%dT%H:%M:%S.%f%z","level":"%l","thread":%t,"msg":"%*"})");
+        json_sink->set_formatter(std::move(formatter));
+
+        sinks.push_back(json_sink);
+    }
+
+    spdlog::drop("afv_native");
+    auto afv_logger = std::make_shared<spdlog::async_logger>("afv_native", sinks.begin(), sinks.end(),
+        spdlog::thread_pool(), spdlog::async_overflow_policy::block);
+    afv_logger->flush_on(spdlog::level::warn);
+    spdlog::register_logger(afv_logger);
+
+    apply_log_levels();
+}
+
+void Configuration::apply_log_levels()
+{
+    // Setting the global level goes for every logger, afv-native's included,
+    // so its own level comes after
+    spdlog::set_level(spdlog::level::from_str(shared::logLevel));
+
+    if (auto afv_logger = spdlog::get("afv_native")) {
+        afv_logger->set_level(spdlog::level::from_str(shared::afvLogLevel));
+    }
+}
+
 std::filesystem::path Configuration::get_config_folder_path()
 {
     std::filesystem::path folder_path;
@@ -113,10 +468,29 @@ std::filesystem::path Configuration::get_config_folder_path()
     folder_path = get_resource_folder();
 #endif
 
+    if (!instance_name_.empty()) {
+        folder_path /= std::filesystem::path("instances") / std::filesystem::path(instance_name_);
+    }
+
     if (!std::filesystem::exists(folder_path)) {
-        std::filesystem::create_directory(folder_path);
+        std::filesystem::create_directories(folder_path);
     }
 
     return folder_path;
 };
+
+bool Configuration::set_instance_name(const std::string& name)
+{
+    if (name.empty()
+        || !std::all_of(name.begin(), name.end(), [](unsigned char c) {
+               return std::isalnum(c) != 0 || c == '-' || c == '_';
+           })) {
+        return false;
+    }
+
+    instance_name_ = name;
+    return true;
+}
+
+const std::string& Configuration::get_instance_name() { return instance_name_; }
 } // namespace vector_audio
\ No newline at end of file
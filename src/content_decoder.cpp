@@ -0,0 +1,75 @@
+#include "content_decoder.h"
+#include <array>
+#include <spdlog/spdlog.h>
+
+namespace vector_audio::vatsim {
+
+ContentDecoder::ContentDecoder(const std::string& encoding)
+{
+    if (encoding != "gzip" && encoding != "deflate") {
+        return;
+    }
+
+    // 32 on top of the window size lets zlib detect the gzip or zlib header
+    compressed_ = inflateInit2(&stream_, MAX_WBITS + 32) == Z_OK;
+    if (!compressed_) {
+        spdlog::error("Could not set up a {} decoder", encoding);
+        done_ = true;
+    }
+}
+
+ContentDecoder::~ContentDecoder()
+{
+    if (compressed_) {
+        inflateEnd(&stream_);
+    }
+}
+
+bool ContentDecoder::decode(
+    const char* data, std::size_t size, const Sink& sink)
+{
+    if (!compressed_) {
+        return !done_ && sink(data, size);
+    }
+
+    // Anything after the end of the compressed stream is ignored
+    if (done_) {
+        return true;
+    }
+
+    std::array<char, 16384> out;
+    stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    stream_.avail_in = static_cast<uInt>(size);
+
+    // A full output buffer can leave more output pending, even once all the
+    // input is consumed
+    do {
+        stream_.next_out = reinterpret_cast<Bytef*>(out.data());
+        stream_.avail_out = static_cast<uInt>(out.size());
+
+        auto ret = inflate(&stream_, Z_NO_FLUSH);
+        if (ret == Z_BUF_ERROR) {
+            break; // Nothing to do until the next chunk
+        }
+
+        if (ret != Z_OK && ret != Z_STREAM_END) {
+            spdlog::error("Could not decode response: {}",
+                stream_.msg != nullptr ? stream_.msg : "corrupt data");
+            return false;
+        }
+
+        auto produced = out.size() - stream_.avail_out;
+        if (produced > 0 && !sink(out.data(), produced)) {
+            return false;
+        }
+
+        if (ret == Z_STREAM_END) {
+            done_ = true;
+            break;
+        }
+    } while (stream_.avail_in > 0 || stream_.avail_out == 0);
+
+    return true;
+}
+
+}
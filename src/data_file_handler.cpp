@@ -1,76 +1,283 @@
 #include <data_file_handler.h>
+#include "binary_codec.h"
+#include "config.h"
+#include "reachability.h"
+#include "replay.h"
+#include <fstream>
+#include <sstream>
+#include <spdlog/fmt/chrono.h>
 #include <spdlog/spdlog.h>
 
-vector_audio::vatsim::DataHandler::DataHandler()
-    : workerThread_(std::make_unique<std::thread>(&DataHandler::worker, this))
+namespace {
+constexpr std::string_view kCacheFileName = "vatsim_endpoints.bin";
+constexpr std::string_view kCacheMagic = "VACACHE";
+constexpr std::uint64_t kCacheVersion = 1;
+// Older than this, the cache is not worth trusting even for a few seconds
+constexpr std::chrono::hours kCacheMaxAge(24);
+
+// Short enough that an endpoint that stopped answering only costs one poll
+constexpr std::chrono::seconds kConnectTimeout(5);
+
+httplib::Client makeClient(const std::string& host)
+{
+    httplib::Client cli(host);
+    cli.set_connection_timeout(kConnectTimeout);
+    cli.set_read_timeout(10);
+    return cli;
+}
+
+// Nearest rank, p between 0 and 1
+std::chrono::milliseconds percentile(
+    std::vector<std::chrono::milliseconds> samples, double p)
+{
+    if (samples.empty()) {
+        return std::chrono::milliseconds(0);
+    }
+
+    auto rank = static_cast<std::ptrdiff_t>(
+        p * static_cast<double>(samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + rank, samples.end());
+    return samples[rank];
+}
+
+constexpr std::uint32_t suffixCode(char a, char b, char c)
+{
+    return (static_cast<std::uint32_t>(static_cast<unsigned char>(a)) << 16)
+        | (static_cast<std::uint32_t>(static_cast<unsigned char>(b)) << 8)
+        | static_cast<std::uint32_t>(static_cast<unsigned char>(c));
+}
+
+// Checks whether a callsign ends with one of the controller position suffixes,
+// in a single switch over the packed three letter suffix
+bool isControllerCallsign(std::string_view callsign)
+{
+    const auto n = callsign.size();
+    if (n < 4 || callsign[n - 4] != '_') {
+        return false;
+    }
+
+    switch (suffixCode(callsign[n - 3], callsign[n - 2], callsign[n - 1])) {
+    case suffixCode('C', 'T', 'R'):
+    case suffixCode('A', 'P', 'P'):
+    case suffixCode('T', 'W', 'R'):
+    case suffixCode('G', 'N', 'D'):
+    case suffixCode('D', 'E', 'L'):
+    case suffixCode('F', 'S', 'S'):
+    case suffixCode('S', 'U', 'P'):
+    case suffixCode('R', 'D', 'O'):
+    case suffixCode('R', 'M', 'P'):
+    case suffixCode('T', 'M', 'U'):
+    case suffixCode('F', 'M', 'P'):
+        return true;
+    default:
+        return false;
+    }
+}
+}
+
+vector_audio::vatsim::DataHandler::DataHandler(
+    EventLoop& loop, Endpoints endpoints)
+    : loop_(loop)
+    , endpoints_(std::move(endpoints))
+    , strand_(restinio::asio_ns::make_strand(loop.context()))
+    , poll_timer_(strand_)
 {
-    spdlog::debug("Created data file thread");
+    // Offline runs get their responses from a replay log, if at all
+    if (shared::offlineMode) {
+        return;
+    }
+
+    spawn(pollLoop());
+    spdlog::debug("Started polling VATSIM data");
+}
+
+vector_audio::vatsim::DataHandler::~DataHandler()
+{
+    // Aborts the requests in flight, the coroutines see the stop as soon as
+    // they are back on the strand. The timer is cancelled from the strand as
+    // the poll loop arms it there.
+    stop_.request_stop();
+    restinio::asio_ns::post(strand_, [this] { poll_timer_.cancel(); });
+
+    std::unique_lock<std::mutex> lk(tasks_m_);
+    tasks_cv_.wait(lk, [this] { return tasks_ == 0; });
+}
+
+void vector_audio::vatsim::DataHandler::spawn(
+    restinio::asio_ns::awaitable<void> task)
+{
+    {
+        const std::lock_guard<std::mutex> l(tasks_m_);
+        tasks_++;
+    }
+
+    restinio::asio_ns::co_spawn(
+        strand_, std::move(task), [this](const std::exception_ptr& ex) {
+            if (ex) {
+                try {
+                    std::rethrow_exception(ex);
+                } catch (std::exception& e) {
+                    spdlog::error("VATSIM data task failed: {}", e.what());
+                }
+            }
+
+            // Notified under the lock, the destructor may return right after
+            const std::lock_guard<std::mutex> l(tasks_m_);
+            tasks_--;
+            tasks_cv_.notify_all();
+        });
 }
 
+int vector_audio::vatsim::DataHandler::fetch(const std::string& host,
+    const std::string& url, const ContentDecoder::Sink& receiver)
+{
+    // Only a host that answered is handed to httplib, whose connect cannot
+    // be aborted
+    if (!waitUntilReachable(host, kConnectTimeout, stop_.get_token())) {
+        return 0;
+    }
+
+    // We decode the body ourselves, so it can be counted on both sides and
+    // handed on while it downloads
+    auto cli = makeClient(host);
+    cli.set_decompress(false);
+
+    // Shutdown aborts the request from its own thread. A stop that comes in
+    // right before the connection opens is caught by the handlers below.
+    StopCallback cancel(stop_.get_token(), [&cli] { cli.stop(); });
+    if (stop_.stop_requested()) {
+        return 0;
+    }
+
+    int status = 0;
+    std::unique_ptr<ContentDecoder> decoder;
+    std::uint64_t wire_bytes = 0;
+    std::uint64_t decoded_bytes = 0;
+    bool stopped = false;
+    bool corrupt = false;
+
+    auto res = cli.Get(
+        url, { { "Accept-Encoding", ContentDecoder::kAcceptEncoding } },
+        [&](const httplib::Response& response) {
+            status = response.status;
+            decoder = std::make_unique<ContentDecoder>(
+                response.get_header_value("Content-Encoding"));
+            return response.status == 200 && !stop_.stop_requested();
+        },
+        [&](const char* data, size_t size) {
+            if (stop_.stop_requested()) {
+                return false;
+            }
+
+            wire_bytes += size;
+            auto ok = decoder->decode(
+                data, size, [&](const char* out, std::size_t out_size) {
+                    decoded_bytes += out_size;
+                    stopped = !receiver(out, out_size);
+                    return !stopped;
+                });
+
+            corrupt = !ok && !stopped;
+            return ok;
+        });
+
+    wire_bytes_ += wire_bytes;
+    decoded_bytes_ += decoded_bytes;
+    spdlog::debug("Downloaded {}: {} bytes on the wire, {} decoded", url,
+        wire_bytes, decoded_bytes);
+
+    if (stop_.stop_requested()) {
+        return 0;
+    }
+
+    if (status != 200 || stopped) {
+        return status;
+    }
+
+    // A body cut short by the network is as good as no body
+    if (corrupt || !res || !decoder->finished()) {
+        return 0;
+    }
+
+    return status;
+}
 std::string vector_audio::vatsim::DataHandler::downloadString(
-    httplib::Client& cli, std::string url)
+    const std::string& host, std::string url)
 {
-    auto res = cli.Get(url);
-    if (!res) {
+    int status = 0;
+    return downloadString(host, std::move(url), status);
+}
+std::string vector_audio::vatsim::DataHandler::downloadString(
+    const std::string& host, std::string url, int& status)
+{
+    std::string body;
+    status = fetch(host, url, [&body](const char* data, size_t size) {
+        body.append(data, size);
+        return true;
+    });
+
+    if (status == 0) {
+        if (stop_.stop_requested()) {
+            return "";
+        }
+
+        replay::Recorder::record_http_response(url, 0, "");
         spdlog::error("Could not download URL: {}", url);
         return "";
     }
 
-    if (res->status != 200) {
-        spdlog::error("Couldn't load {}, HTTP error {}", url, res->status);
+    replay::Recorder::record_http_response(url, status, body);
+
+    if (status != 200) {
+        spdlog::error("Couldn't load {}, HTTP error {}", url, status);
         return "";
     }
 
-    return res->body;
+    return body;
+}
+vector_audio::vatsim::DataHandler::TransferStats
+vector_audio::vatsim::DataHandler::transferStats()
+{
+    TransferStats stats;
+    stats.wire_bytes = wire_bytes_;
+    stats.decoded_bytes = decoded_bytes_;
+    return stats;
 }
-
 bool vector_audio::vatsim::DataHandler::parseSlurper(
-    const std::string& sluper_data)
+    std::string_view sluper_data, SessionInfo& session)
 {
     if (sluper_data.empty()) {
         return false;
     }
 
-    auto lines = shared::split_string(sluper_data, "\n");
-    std::string callsign;
-    std::string res3;
-    std::string res2;
-    std::string lat;
-    std::string lon;
+    util::StringTokenizer lines(sluper_data, '\n');
+    std::string_view line;
+    parsers::SlurperLine res;
     bool found_not_atis_connection = false;
 
-    for (const auto& line : lines) {
+    while (lines.next(line)) {
         if (line.empty()) {
             continue;
         }
 
-        auto res = shared::split_string(line, ",");
+        if (!parsers::splitSlurperLine(line, res)) {
+            spdlog::warn("Ignoring malformed slurper line");
+            continue;
+        }
 
-        if (util::endsWith(res[1], "_ATIS")) {
+        if (util::endsWith(res.callsign, "_ATIS")) {
             continue; // Ignore ATIS connections
         }
 
         found_not_atis_connection = true;
 
-        if (util::endsWith(res[1], "_CTR") || util::endsWith(res[1], "_APP")
-            || util::endsWith(res[1], "_TWR") || util::endsWith(res[1], "_GND")
-            || util::endsWith(res[1], "_DEL") || util::endsWith(res[1], "_FSS")
-            || util::endsWith(res[1], "_SUP") || util::endsWith(res[1], "_RDO")
-            || util::endsWith(res[1], "_RMP") || util::endsWith(res[1], "_TMU")
-            || util::endsWith(res[1], "_FMP"))
+        if (isControllerCallsign(res.callsign))
             yx_ = true;
 
-        callsign = res[1];
-        res3 = res[3];
-        res2 = res[2];
-
-        lat = res[5];
-        lon = res[6];
-
         break;
     }
 
-    if (callsign == "DCLIENT3") {
+    if (res.callsign == "DCLIENT3") {
         return false;
     }
 
@@ -78,88 +285,280 @@ bool vector_audio::vatsim::DataHandler::parseSlurper(
         return false;
     }
 
-    int u334 = static_cast<int>(std::atof(res3.c_str()) * 1000000);
+    int u334 = util::frequencyFromMHz(res.frequency);
 
-    int k422 = std::stoi(res2, nullptr, 16) == 10 && yx_
-            && u334 != shared::kObsFrequency
-        ? 1
-        : 0;
+    int type = 0;
+    std::from_chars(res.type.data(), res.type.data() + res.type.size(), type,
+        16);
+    int k422 = type == 10 && yx_ && u334 != shared::kObsFrequency ? 1 : 0;
 
-    if (shared::session::is_connected
-        && shared::session::callsign != callsign) {
+    if (sessionCallsignChanged(res.callsign)) {
         spdlog::warn(
             "Detected an active session but with a different callsign");
         return false; // If the callsign changes during an active session, we
                       // disconnect
     }
 
-    vector_audio::vatsim::DataHandler::updateSessionInfo(callsign,
-        util::cleanUpFrequency(u334), k422, std::atof(lat.c_str()),
-        std::atof(lon.c_str()));
+    session.callsign = std::string(res.callsign);
+    session.frequency = util::cleanUpFrequency(u334);
+    session.facility = k422;
+    session.latitude = util::toDouble(res.latitude);
+    session.longitude = util::toDouble(res.longitude);
 
     return true;
 }
 bool vector_audio::vatsim::DataHandler::getLatestDatafileURL()
 {
-    auto cli = httplib::Client(vatsim_status_host);
-    auto res = this->downloadString(cli, vatsim_status_url);
-
-    try {
-        if (!nlohmann::json::accept(res)) {
-            return false;
+    auto res = this->downloadString(
+        endpoints_.status_server, endpoints_.status_path);
+
+    std::vector<DatafileMirror> mirrors;
+    for (const auto& status_file : parsers::parseStatusFile(res)) {
+        DatafileMirror mirror;
+        if (!parsers::splitDatafileUrl(
+                status_file, mirror.host, mirror.url)) {
+            spdlog::warn("Ignoring invalid datafile URL: {}", status_file);
+            continue;
         }
+        mirrors.push_back(std::move(mirror));
+    }
 
-        auto status_json = nlohmann::json::parse(res);
+    if (mirrors.empty()) {
+        return false;
+    }
+
+    const std::lock_guard<std::mutex> l(mirrors_m_);
+    datafile_mirrors_ = std::move(mirrors);
+    return true;
+}
+// Checks a mirror without downloading the datafile. We only fetch the headers,
+// and fall back to a single byte range request for servers that do not allow
+// HEAD.
+void vector_audio::vatsim::DataHandler::probeMirror(DatafileMirror& mirror)
+{
+    auto start = std::chrono::steady_clock::now();
+    if (!waitUntilReachable(
+            mirror.host, kConnectTimeout, stop_.get_token())) {
+        mirror.latency = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+        mirror.healthy = false;
+        return;
+    }
 
-        auto number_of_status_files
-            = status_json["data"]["v3"].get<std::vector<std::string>>().size();
+    auto cli = makeClient(mirror.host);
+    StopCallback cancel(stop_.get_token(), [&cli] { cli.stop(); });
+    if (stop_.stop_requested()) {
+        mirror.healthy = false;
+        return;
+    }
 
-        auto selected_file_index = number_of_status_files == 1
-            ? 0
-            : std::rand() % number_of_status_files;
+    auto res = cli.Head(mirror.url);
+    if (res && (res->status == 405 || res->status == 501)) {
+        res = cli.Get(mirror.url, { httplib::make_range_header({ { 0, 0 } }) });
+    }
 
-        auto data
-            = status_json["data"]["v3"][selected_file_index].get<std::string>();
+    mirror.latency = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
 
-        std::regex regex(url_regex);
-        std::smatch m;
-        std::regex_match(data, m, regex);
-        if (m.size() == 4) {
-            datafile_host_ = m[1].str() + m[2].str();
-            datafile_url_ = m[3].str();
-            return true;
-        }
-    } catch (std::exception& e) {
-        spdlog::error("Status file check failed: %s", e.what());
+    if (!res) {
+        mirror.healthy = false;
+    } else if (res->status == 200 || res->status == 206) {
+        // An empty datafile is as good as no datafile
+        mirror.healthy = !res->has_header("Content-Length")
+            || res->get_header_value("Content-Length") != "0";
+    } else {
+        spdlog::error("Couldn't probe {}{}, HTTP error {}", mirror.host,
+            mirror.url, res->status);
+        mirror.healthy = false;
     }
 
-    return false;
+    spdlog::debug("Datafile mirror {} is {} ({})", mirror.host,
+        mirror.healthy ? "up" : "down", mirror.latency);
 }
 bool vector_audio::vatsim::DataHandler::checkIfdatafileAvailable()
 {
-    auto cli = httplib::Client(this->datafile_host_);
-    auto res = vector_audio::vatsim::DataHandler::downloadString(
-        cli, this->datafile_url_);
+    std::vector<DatafileMirror> mirrors;
+    {
+        const std::lock_guard<std::mutex> l(mirrors_m_);
+        mirrors = datafile_mirrors_;
+    }
 
-    return !res.empty();
+    // Probe all mirrors at once, so the probe takes as long as the slowest
+    // mirror rather than the sum of all of them
+    std::vector<std::future<void>> probes;
+    probes.reserve(mirrors.size());
+    for (auto& mirror : mirrors) {
+        probes.push_back(std::async(std::launch::async,
+            &vector_audio::vatsim::DataHandler::probeMirror, this,
+            std::ref(mirror)));
+    }
+
+    for (auto& probe : probes) {
+        probe.wait();
+    }
+
+    // Healthy mirrors first, fastest first
+    std::stable_sort(mirrors.begin(), mirrors.end(),
+        [](const DatafileMirror& a, const DatafileMirror& b) {
+            if (a.healthy != b.healthy) {
+                return a.healthy;
+            }
+            return a.latency < b.latency;
+        });
+
+    bool available = !mirrors.empty() && mirrors.front().healthy;
+    if (available) {
+        spdlog::info("Using datafile mirror {}", mirrors.front().host);
+    }
+
+    const std::lock_guard<std::mutex> l(mirrors_m_);
+    datafile_mirrors_ = std::move(mirrors);
+    return available;
 };
+// Feeds the datafile to the parser as it arrives rather than buffering the
+// whole body first, so parsing overlaps the download and memory use stays
+// bounded by the pipe. The parse, and the download with it, stops as soon as
+// the handler found its entry.
+vector_audio::vatsim::DataHandler::StreamResult
+vector_audio::vatsim::DataHandler::streamFromMirror(
+    const DatafileMirror& mirror, const std::vector<std::string>& arrays,
+    const DatafileSax::ElementHandler& handler, bool record)
+{
+    constexpr std::size_t kMaxBuffered = 256 * 1024;
+
+    // A recording keeps the elements the parse read rather than the body,
+    // the same parse on them during a replay gives the same result
+    const bool recording = record && replay::Recorder::is_recording();
+    auto consumed = nlohmann::json::object();
+
+    ChunkPipe pipe(kMaxBuffered);
+    DatafileSax sax(arrays,
+        [&handler, &consumed, recording](
+            const std::string& array, const nlohmann::json& element) {
+            if (recording) {
+                consumed[array].push_back(element);
+            }
+            return handler(array, element);
+        });
+    bool handler_failed = false;
+
+    std::thread parser([&pipe, &sax, &handler_failed] {
+        std::istream in(&pipe);
+        try {
+            nlohmann::json::sax_parse(in, &sax);
+        } catch (std::exception& e) {
+            spdlog::error("Failed to parse datafile: {}", e.what());
+            handler_failed = true;
+        }
+        pipe.stop();
+    });
+
+    auto status
+        = fetch(mirror.host, mirror.url, [&](const char* data, size_t size) {
+              return pipe.write(data, size);
+          });
+
+    pipe.close();
+    parser.join();
+
+    if (recording) {
+        replay::Recorder::record_http_response(
+            mirror.url, status, consumed.dump());
+    }
+
+    if (status == 0) {
+        spdlog::error("Could not download URL: {}", mirror.url);
+        return StreamResult::Failed;
+    }
+
+    if (status != 200) {
+        spdlog::error("Couldn't load {}, HTTP error {}", mirror.url, status);
+        return StreamResult::Failed;
+    }
+
+    if (sax.found()) {
+        return StreamResult::Found;
+    }
+
+    // A download cut short shows up as a parse error
+    return sax.failed() || handler_failed ? StreamResult::Failed
+                                          : StreamResult::NotFound;
+}
+vector_audio::vatsim::DataHandler::StreamResult
+vector_audio::vatsim::DataHandler::streamDatafile(
+    const std::vector<std::string>& arrays,
+    const DatafileSax::ElementHandler& handler,
+    const std::function<void()>& reset, bool record)
+{
+    // Mirrors are ranked, so the first healthy one is the fastest. If it fails
+    // we mark it down and immediately move on to the next one rather than
+    // waiting for the next endpoint probe.
+    while (true) {
+        DatafileMirror mirror;
+        {
+            const std::lock_guard<std::mutex> l(mirrors_m_);
+            auto it = std::find_if(datafile_mirrors_.begin(),
+                datafile_mirrors_.end(),
+                [](const DatafileMirror& m) { return m.healthy; });
+
+            if (it == datafile_mirrors_.end()) {
+                this->dataFileAvailable_ = false;
+                return StreamResult::Failed;
+            }
+            mirror = *it;
+        }
+
+        if (reset) {
+            reset();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        auto res = streamFromMirror(mirror, arrays, handler, record);
+        auto latency = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+
+        spdlog::debug("Datafile from {} parsed in {}", mirror.host, latency);
+
+        {
+            const std::lock_guard<std::mutex> l(mirrors_m_);
+            auto it = std::find_if(datafile_mirrors_.begin(),
+                datafile_mirrors_.end(), [&mirror](const DatafileMirror& m) {
+                    return m.host == mirror.host && m.url == mirror.url;
+                });
+
+            if (it != datafile_mirrors_.end()) {
+                it->healthy = res != StreamResult::Failed;
+                it->latency = latency;
+            }
+        }
+
+        if (res != StreamResult::Failed) {
+            return res;
+        }
+
+        spdlog::warn("Datafile mirror {} failed, failing over", mirror.host);
+    }
+}
 bool vector_audio::vatsim::DataHandler::checkIfSlurperAvailable()
 {
-    auto cli = httplib::Client(slurper_host);
-    auto res
-        = vector_audio::vatsim::DataHandler::downloadString(cli, slurper_url);
+    auto res = this->downloadString(
+        endpoints_.slurper_server, endpoints_.slurper_path);
 
     return res == "Must Provide CID";
 };
 void vector_audio::vatsim::DataHandler::getAvailableEndpoints()
 {
+    // The slurper does not depend on the status file, so we probe it while the
+    // datafile mirrors are being checked
+    auto slurper_probe = std::async(std::launch::async,
+        &vector_audio::vatsim::DataHandler::checkIfSlurperAvailable, this);
+
     auto status_available = this->getLatestDatafileURL();
     if (status_available) {
         this->dataFileAvailable_ = this->checkIfdatafileAvailable();
     }
 
-    this->slurperAvailable_
-        = vector_audio::vatsim::DataHandler::checkIfSlurperAvailable();
+    this->slurperAvailable_ = slurper_probe.get();
 }
 void vector_audio::vatsim::DataHandler::resetSessionData()
 {
@@ -189,56 +588,155 @@ void vector_audio::vatsim::DataHandler::handleDisconnect()
 
     this->had_one_disconnect_ = true;
 };
-bool vector_audio::vatsim::DataHandler::parseDatafile(const std::string& data)
+bool vector_audio::vatsim::DataHandler::matchController(
+    const nlohmann::json& controller, bool& connected, SessionInfo& session)
 {
-    try {
-        if (!nlohmann::json::accept(data)) {
-            spdlog::error("Failed to parse datafile: not valid JSON");
-            return false;
-        }
+    auto cid = controller.find("cid");
+    if (cid == controller.end() || *cid != vector_audio::shared::vatsim_cid) {
+        return false;
+    }
 
-        auto v3_datafile = nlohmann::json::parse(data);
+    connected = false;
 
-        for (auto controller : v3_datafile["controllers"]) {
-            if (controller["cid"] == vector_audio::shared::vatsim_cid) {
+    auto callsign = controller.at("callsign").get<std::string>();
+    if (sessionCallsignChanged(callsign)) {
+        spdlog::warn("Detected an active session but with a "
+                     "different callsign, disconnecting");
+        return true; // If the callsign changes during an active session, we
+                     // disconnect
+    }
 
-                auto callsign = controller["callsign"].get<std::string>();
-                if (shared::session::is_connected
-                    && shared::session::callsign != callsign) {
-                    spdlog::warn("Detected an active session but with a "
-                                 "different callsign, disconnecting");
-                    return false; // If the callsign changes during an
-                                  // active session, we disconnect
-                }
+    // Get current user frequency
+    int u334 = util::frequencyFromMHz(
+        controller.at("frequency").get<std::string>());
 
-                // Get current user frequency
-                int u334 = static_cast<int>(
-                    std::atof(
-                        controller["frequency"].get<std::string>().c_str())
-                    * 1000000);
+    session = SessionInfo();
+    session.callsign = callsign;
+    session.frequency = util::cleanUpFrequency(u334);
+    session.facility = controller.at("facility").get<int>();
 
-                vector_audio::vatsim::DataHandler::updateSessionInfo(callsign,
-                    util::cleanUpFrequency(u334),
-                    controller["facility"].get<int>());
+    connected = true;
+    return true;
+}
+vector_audio::vatsim::DatafileSax::ElementHandler
+vector_audio::vatsim::DataHandler::sessionHandler(
+    std::optional<DatafileSnapshot>& snapshot, bool& found, bool& connected,
+    SessionInfo& session)
+{
+    return [&snapshot, &found, &connected, &session](
+               const std::string& array, const nlohmann::json& element) {
+        if (snapshot) {
+            snapshot->add(array, element);
+        }
 
-                return true;
-            }
+        if (!found && array == "controllers") {
+            found = matchController(element, connected, session);
         }
+
+        // Without a snapshot to fill there is nothing to read past our entry
+        return found && !snapshot;
+    };
+}
+bool vector_audio::vatsim::DataHandler::parseDatafile(const std::string& data)
+{
+    std::optional<DatafileSnapshot> snapshot;
+    if (this->hasChangeHandlers()) {
+        snapshot.emplace();
+    }
+
+    std::vector<std::string> arrays { "controllers" };
+    if (snapshot) {
+        arrays.emplace_back("pilots");
+    }
+
+    bool found = false;
+    bool connected = false;
+    SessionInfo session;
+    DatafileSax sax(
+        arrays, sessionHandler(snapshot, found, connected, session));
+
+    try {
+        nlohmann::json::sax_parse(data, &sax);
     } catch (std::exception& e) {
-        spdlog::error("Failed to parse datafile: %s", e.what());
+        spdlog::error("Failed to parse datafile: {}", e.what());
+        return false;
     }
 
-    return false;
+    if (snapshot && !sax.failed()) {
+        this->publishChanges(std::move(*snapshot));
+    }
+
+    if (found && connected) {
+        updateSessionInfo(session);
+    }
+
+    return found && connected;
+}
+int vector_audio::vatsim::DataHandler::subscribeToChanges(ChangeHandler handler)
+{
+    const std::lock_guard<std::mutex> l(change_handlers_m_);
+    auto id = next_change_handler_++;
+    change_handlers_.emplace(id, std::move(handler));
+    return id;
+}
+void vector_audio::vatsim::DataHandler::unsubscribeFromChanges(int id)
+{
+    const std::lock_guard<std::mutex> l(change_handlers_m_);
+    change_handlers_.erase(id);
+
+    // Nobody keeps track of the changes anymore, so the next subscriber starts
+    // from scratch
+    if (change_handlers_.empty()) {
+        snapshot_.reset();
+    }
+}
+bool vector_audio::vatsim::DataHandler::hasChangeHandlers()
+{
+    const std::lock_guard<std::mutex> l(change_handlers_m_);
+    return !change_handlers_.empty();
 }
-void vector_audio::vatsim::DataHandler::updateSessionInfo(std::string callsign,
-    int frequency, int facility, double latitude, double longitude)
+void vector_audio::vatsim::DataHandler::publishChanges(
+    DatafileSnapshot snapshot)
+{
+    // Held while the handlers run, so unsubscribing waits for them
+    const std::lock_guard<std::mutex> l(change_handlers_m_);
+    if (change_handlers_.empty()) {
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto changes = snapshot.diff(snapshot_ ? *snapshot_ : DatafileSnapshot());
+    snapshot_ = std::move(snapshot);
+
+    spdlog::debug("Datafile has {} changes over {} entries, diffed in {}",
+        changes.size(), snapshot_->size(),
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start));
+
+    if (changes.empty()) {
+        return;
+    }
+
+    for (const auto& [id, handler] : change_handlers_) {
+        handler(changes);
+    }
+}
+bool vector_audio::vatsim::DataHandler::sessionCallsignChanged(
+    std::string_view callsign)
+{
+    const std::lock_guard<std::mutex> l(shared::session::m);
+    return shared::session::is_connected
+        && shared::session::callsign != callsign;
+}
+void vector_audio::vatsim::DataHandler::updateSessionInfo(
+    const SessionInfo& session)
 {
     const std::lock_guard<std::mutex> l(shared::session::m);
-    shared::session::callsign = std::move(callsign);
-    shared::session::facility = facility;
-    shared::session::latitude = latitude;
-    shared::session::longitude = longitude;
-    shared::session::frequency = frequency;
+    shared::session::callsign = session.callsign;
+    shared::session::facility = session.facility;
+    shared::session::latitude = session.latitude;
+    shared::session::longitude = session.longitude;
+    shared::session::frequency = session.frequency;
 }
 void vector_audio::vatsim::DataHandler::handleConnect()
 {
@@ -250,141 +748,574 @@ void vector_audio::vatsim::DataHandler::handleConnect()
     spdlog::info("Detected VATSIM client connection");
     shared::session::is_connected = true;
 }
-void vector_audio::vatsim::DataHandler::worker()
+void vector_audio::vatsim::DataHandler::replayResponse(
+    const std::string& url, int status, const std::string& body)
+{
+    // Failed requests were recorded with an empty body, which the parsers
+    // already treat as a failure
+    const std::string& data = status == 200 ? body : std::string();
+
+    if (url == endpoints_.status_path) {
+        this->dataFileAvailable_ = !parsers::parseStatusFile(data).empty();
+        return;
+    }
+
+    if (url == endpoints_.slurper_path) {
+        this->slurperAvailable_ = data == "Must Provide CID";
+        return;
+    }
+
+    // As live, a session check that got no answer leaves the session alone
+    if (status != 200) {
+        return;
+    }
+
+    bool res = false;
+    if (util::startsWith(url, endpoints_.slurper_path)) {
+        // Pilot position lookups share the URL, only session checks matter
+        if (url.substr(endpoints_.slurper_path.size())
+            != std::to_string(shared::vatsim_cid)) {
+            return;
+        }
+        SessionInfo session;
+        res = this->parseSlurper(data, session);
+        if (res) {
+            updateSessionInfo(session);
+        }
+    } else {
+        res = this->parseDatafile(data);
+    }
+
+    if (!res) {
+        handleDisconnect();
+    } else {
+        handleConnect();
+    }
+}
+bool vector_audio::vatsim::DataHandler::loadEndpointCache()
 {
+    if (!endpoints_.use_cache) {
+        return false;
+    }
+
+    auto path = Configuration::get_config_folder_path() / kCacheFileName;
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    auto content = buffer.str();
+    std::string_view data(content);
+
+    if (data.substr(0, kCacheMagic.size()) != kCacheMagic) {
+        spdlog::warn("Ignoring an invalid endpoint cache");
+        return false;
+    }
+    data.remove_prefix(kCacheMagic.size());
+
+    std::uint64_t version = 0;
+    std::uint64_t saved_at = 0;
+    std::uint64_t slurper_available = 0;
+    std::uint64_t count = 0;
+    if (!codec::getVarint(data, version) || version != kCacheVersion
+        || !codec::getVarint(data, saved_at)
+        || !codec::getVarint(data, slurper_available)
+        || !codec::getVarint(data, count)) {
+        spdlog::warn("Ignoring an invalid endpoint cache");
+        return false;
+    }
+
+    auto age = std::chrono::system_clock::now()
+        - std::chrono::system_clock::time_point(
+            std::chrono::seconds(saved_at));
+    if (age > kCacheMaxAge) {
+        return false;
+    }
+
+    std::vector<DatafileMirror> mirrors;
+    for (std::uint64_t i = 0; i < count; i++) {
+        DatafileMirror mirror;
+        std::uint64_t latency = 0;
+        std::uint64_t healthy = 0;
+        if (!codec::getString(data, mirror.host)
+            || !codec::getString(data, mirror.url)
+            || !codec::getVarint(data, latency)
+            || !codec::getVarint(data, healthy)) {
+            spdlog::warn("Ignoring an invalid endpoint cache");
+            return false;
+        }
+
+        mirror.latency = std::chrono::milliseconds(latency);
+        mirror.healthy = healthy != 0;
+        mirrors.push_back(std::move(mirror));
+    }
+
+    bool datafile_available = std::any_of(mirrors.begin(), mirrors.end(),
+        [](const DatafileMirror& m) { return m.healthy; });
+
     {
-        const std::lock_guard<std::mutex> l(shared::session::m);
-        this->getAvailableEndpoints();
+        const std::lock_guard<std::mutex> l(mirrors_m_);
+        datafile_mirrors_ = std::move(mirrors);
     }
 
-    std::unique_lock<std::mutex> lk(m_);
-    do {
-        if (!this->isSlurperAvailable() || !this->isDatafileAvailable()) {
+    this->slurperAvailable_ = slurper_available != 0;
+    this->dataFileAvailable_ = datafile_available;
+    return true;
+}
+void vector_audio::vatsim::DataHandler::saveEndpointCache()
+{
+    // Probes aborted by shutdown would all show up as down
+    if (!endpoints_.use_cache || stop_.stop_requested()) {
+        return;
+    }
+
+    auto saved_at = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch());
+
+    std::string out(kCacheMagic);
+    codec::putVarint(out, kCacheVersion);
+    codec::putVarint(out, static_cast<std::uint64_t>(saved_at.count()));
+    codec::putVarint(out, this->slurperAvailable_ ? 1 : 0);
+
+    {
+        const std::lock_guard<std::mutex> l(mirrors_m_);
+        codec::putVarint(out, datafile_mirrors_.size());
+        for (const auto& mirror : datafile_mirrors_) {
+            codec::putString(out, mirror.host);
+            codec::putString(out, mirror.url);
+            codec::putVarint(
+                out, static_cast<std::uint64_t>(mirror.latency.count()));
+            codec::putVarint(out, mirror.healthy ? 1 : 0);
+        }
+    }
+
+    // Written aside and moved in place, so a crash never leaves half a cache
+    auto path = Configuration::get_config_folder_path() / kCacheFileName;
+    auto temp_path = path;
+    temp_path += ".tmp";
+
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        file.write(out.data(), static_cast<std::streamsize>(out.size()));
+        file.close();
+
+        if (!file) {
+            spdlog::warn("Could not write endpoint cache to {}",
+                temp_path.string());
+            return;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(temp_path, path, ec);
+    if (ec) {
+        spdlog::warn("Could not replace endpoint cache: {}", ec.message());
+    }
+}
+restinio::asio_ns::awaitable<void>
+vector_audio::vatsim::DataHandler::pollLoop()
+{
+    auto start = std::chrono::steady_clock::now();
+
+    // With a recent cache the first session check does not wait for the
+    // probes, they run right after it
+    bool from_cache = this->loadEndpointCache();
+    if (!from_cache) {
+        co_await loop_.runBlocking([this] {
+            const std::lock_guard<std::mutex> l(shared::session::m);
             this->getAvailableEndpoints();
+            this->saveEndpointCache();
+        });
+    }
+
+    spdlog::info("VATSIM endpoints known after {}{}",
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start),
+        from_cache ? ", from the cache" : "");
+
+    while (!stop_.stop_requested()) {
+        if (!this->isSlurperAvailable() || !this->isDatafileAvailable()) {
+            co_await loop_.runBlocking([this] {
+                this->getAvailableEndpoints();
+                this->saveEndpointCache();
+            });
         }
 
-        auto res = false;
+        bool read_datafile = false;
+        auto res = co_await this->checkSession(read_datafile);
 
-        if (this->isSlurperAvailable()) {
-            res = this->getConnectionStatusWithSlurper();
-        } else if (this->isDatafileAvailable()) {
-            res = this->getConnectionStatusWithDatafile();
+        // Subscribers get a datafile every poll, unless the session check
+        // already went through it
+        if (!read_datafile && this->isSlurperAvailable()
+            && this->isDatafileAvailable() && this->hasChangeHandlers()) {
+            co_await loop_.runBlocking([this] { this->pollDatafileChanges(); });
         }
 
+        // A check aborted by shutdown says nothing about the session
+        if (stop_.stop_requested()) {
+            break;
+        }
+
+        // Neither does one whose download failed or came in corrupt
         if (!res) {
+            spdlog::warn("Session check got no answer, keeping the session");
+        } else if (!*res) {
             handleDisconnect();
         } else {
             handleConnect();
         }
 
-    } while (!cv_.wait_for(lk, 15s, [this] { return !keep_running_; }));
+        if (from_cache) {
+            from_cache = false;
+            co_await loop_.runBlocking([this] {
+                this->getAvailableEndpoints();
+                this->saveEndpointCache();
+            });
+        }
+
+        // Checked right before the timer is armed, on the strand, so the
+        // cancel from the destructor cannot slip in between
+        if (stop_.stop_requested()) {
+            break;
+        }
+
+        poll_timer_.expires_after(endpoints_.poll_interval);
+        try {
+            co_await poll_timer_.async_wait(restinio::asio_ns::use_awaitable);
+        } catch (std::exception&) {
+            // Cancelled, the loop condition tells whether we are stopping
+        }
+    }
 }
-bool vector_audio::vatsim::DataHandler::getConnectionStatusWithSlurper()
+restinio::asio_ns::awaitable<std::optional<bool>>
+vector_audio::vatsim::DataHandler::checkSession(bool& read_datafile)
 {
+    auto start = std::chrono::steady_clock::now();
+    read_datafile = false;
+
     if (!this->isSlurperAvailable()) {
-        return false;
+        if (!this->isDatafileAvailable()) {
+            co_return false;
+        }
+
+        read_datafile = true;
+        SessionInfo session;
+        auto connected = co_await loop_.runBlocking([this, &session] {
+            return this->getConnectionStatusWithDatafile(session);
+        });
+        if (connected.value_or(false)) {
+            updateSessionInfo(session);
+        }
+
+        recordSessionCheck(
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start),
+            false, SessionSource::Datafile);
+        co_return connected;
     }
 
-    if (shared::vatsim_cid == 0) {
-        return false;
+    auto race = std::make_shared<SessionRace>(strand_);
+    spawn(runSessionCheck(race, SessionSource::Slurper));
+
+    // The datafile only goes out if the slurper is slower than it usually is
+    bool hedged = false;
+    if (this->isDatafileAvailable()) {
+        race->wake.expires_after(hedgeDelay());
+        try {
+            co_await race->wake.async_wait(restinio::asio_ns::use_awaitable);
+        } catch (std::exception&) {
+            // Woken up by the answer
+        }
+
+        if (!race->answered && !stop_.stop_requested()) {
+            hedged = true;
+            read_datafile = true;
+            spawn(runSessionCheck(race, SessionSource::Datafile));
+        }
     }
 
-    auto cli = httplib::Client(slurper_host);
-    std::string res;
-    {
-        const std::lock_guard<std::mutex> l(shared::session::m);
-        std::string url_with_params
-            = std::string(slurper_url) + std::to_string(shared::vatsim_cid);
-        res = vector_audio::vatsim::DataHandler::downloadString(
-            cli, url_with_params);
+    // Each check wakes us when it ends, and they end on shutdown too as their
+    // requests are aborted
+    while (!race->answered) {
+        race->wake.expires_at(
+            restinio::asio_ns::steady_timer::time_point::max());
+        try {
+            co_await race->wake.async_wait(restinio::asio_ns::use_awaitable);
+        } catch (std::exception&) {
+            // Woken up by the answer
+        }
+    }
+
+    if (race->connected.value_or(false)) {
+        updateSessionInfo(race->info);
     }
 
-    return this->parseSlurper(res);
+    recordSessionCheck(std::chrono::duration_cast<std::chrono::milliseconds>(
+                           std::chrono::steady_clock::now() - start),
+        hedged, race->winner);
+    co_return race->connected;
 }
-bool vector_audio::vatsim::DataHandler::getConnectionStatusWithDatafile()
+restinio::asio_ns::awaitable<void>
+vector_audio::vatsim::DataHandler::runSessionCheck(
+    std::shared_ptr<SessionRace> race, SessionSource source)
 {
-    if (!this->isDatafileAvailable()) {
-        return false;
+    auto start = std::chrono::steady_clock::now();
+
+    SessionInfo session;
+    auto connected = co_await loop_.runBlocking([this, source, &session] {
+        return source == SessionSource::Slurper
+            ? this->getConnectionStatusWithSlurper(session)
+            : this->getConnectionStatusWithDatafile(session);
+    });
+
+    // Slow slurper answers count towards the hedge delay even when the
+    // datafile won
+    if (source == SessionSource::Slurper) {
+        const std::lock_guard<std::mutex> l(session_stats_m_);
+        slurper_latencies_.push_back(
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start));
+        if (slurper_latencies_.size() > kSessionSamples) {
+            slurper_latencies_.pop_front();
+        }
     }
 
-    auto cli = httplib::Client(this->datafile_host_);
-    std::string res = vector_audio::vatsim::DataHandler::downloadString(
-        cli, this->datafile_url_);
+    if (race->answered) {
+        co_return;
+    }
 
-    return this->parseDatafile(res);
+    race->answered = true;
+    race->winner = source;
+    race->connected = connected;
+    race->info = std::move(session);
+    race->wake.cancel();
 }
-bool vector_audio::vatsim::DataHandler::getPilotPositionWithSlurper(
-    const std::string& callsign, double& latitude, double& longitude)
+std::chrono::milliseconds vector_audio::vatsim::DataHandler::hedgeDelay()
 {
-    if (!this->isSlurperAvailable()) {
-        return false;
+    const std::lock_guard<std::mutex> l(session_stats_m_);
+    if (slurper_latencies_.size() < kMinHedgeSamples) {
+        return kDefaultHedgeDelay;
     }
 
-    auto cli = httplib::Client(slurper_host);
-    std::string res;
-    std::string url_with_params = std::string(slurper_url) + callsign;
-    res = vector_audio::vatsim::DataHandler::downloadString(
-        cli, url_with_params);
+    auto p95 = percentile(
+        { slurper_latencies_.begin(), slurper_latencies_.end() }, 0.95);
+    return std::clamp<std::chrono::milliseconds>(
+        p95, kMinHedgeDelay, kMaxHedgeDelay);
+}
+void vector_audio::vatsim::DataHandler::recordSessionCheck(
+    std::chrono::milliseconds latency, bool hedged, SessionSource winner)
+{
+    const std::lock_guard<std::mutex> l(session_stats_m_);
+    detection_latencies_.push_back(latency);
+    if (detection_latencies_.size() > kSessionSamples) {
+        detection_latencies_.pop_front();
+    }
+
+    session_stats_.checks++;
+    if (hedged) {
+        session_stats_.hedged++;
+        if (winner == SessionSource::Datafile) {
+            session_stats_.datafile_won++;
+        }
+    }
 
-    if (res.empty()) {
+    spdlog::debug("Session check answered by the {} in {}{}",
+        winner == SessionSource::Slurper ? "slurper" : "datafile", latency,
+        hedged ? ", hedged" : "");
+
+    // Every few minutes at the usual poll interval
+    if (session_stats_.checks % 20 == 0) {
+        std::vector<std::chrono::milliseconds> samples(
+            detection_latencies_.begin(), detection_latencies_.end());
+        spdlog::info("Session checks: p50 {}, p99 {}, {} of {} hedged, {} "
+                     "answered by the datafile",
+            percentile(samples, 0.5), percentile(samples, 0.99),
+            session_stats_.hedged, session_stats_.checks,
+            session_stats_.datafile_won);
+    }
+}
+vector_audio::vatsim::DataHandler::SessionCheckStats
+vector_audio::vatsim::DataHandler::sessionCheckStats()
+{
+    const std::lock_guard<std::mutex> l(session_stats_m_);
+    std::vector<std::chrono::milliseconds> samples(
+        detection_latencies_.begin(), detection_latencies_.end());
+
+    auto stats = session_stats_;
+    stats.p50 = percentile(samples, 0.5);
+    stats.p99 = percentile(samples, 0.99);
+    return stats;
+}
+bool vector_audio::vatsim::DataHandler::checkSessionNow()
+{
+    std::promise<bool> result;
+    auto answer = result.get_future();
+    spawn(answerSessionCheck(std::move(result)));
+
+    // The coroutine owns the promise. If the loop stopped, it may never run,
+    // or be destroyed unrun and break the promise.
+    if (answer.wait_for(kSessionCheckTimeout) != std::future_status::ready) {
+        spdlog::error(
+            "Session check did not finish in {}", kSessionCheckTimeout);
         return false;
     }
 
     try {
-        auto lines = shared::split_string(res, "\n");
-        for (const auto& line : lines) {
-            auto splits = shared::split_string(line, ",");
+        return answer.get();
+    } catch (std::future_error& ex) {
+        spdlog::error("Session check was dropped: {}", ex.what());
+        return false;
+    }
+}
+restinio::asio_ns::awaitable<void>
+vector_audio::vatsim::DataHandler::answerSessionCheck(
+    std::promise<bool> result)
+{
+    // The caller blocks on the result, so it is set whatever happens
+    bool connected = false;
+    try {
+        bool read_datafile = false;
+        auto res = co_await this->checkSession(read_datafile);
+        connected = res.value_or(false);
+    } catch (std::exception& ex) {
+        spdlog::error("Session check failed: {}", ex.what());
+    }
 
-            if (splits[2] == "pilot") {
-                latitude = std::stod(splits[5]);
-                longitude = std::stod(splits[6]);
+    result.set_value(connected);
+}
+void vector_audio::vatsim::DataHandler::findPilotPosition(
+    std::string callsign, PilotPositionHandler done)
+{
+    spawn(lookupPilot(std::move(callsign), std::move(done)));
+}
+restinio::asio_ns::awaitable<void>
+vector_audio::vatsim::DataHandler::lookupPilot(
+    std::string callsign, PilotPositionHandler done)
+{
+    double latitude = 0.0;
+    double longitude = 0.0;
+    bool found = false;
+
+    if (!stop_.stop_requested()) {
+        found = co_await loop_.runBlocking([&] {
+            return this->getPilotPositionWithAnything(
+                callsign, latitude, longitude);
+        });
+    }
 
-                return true;
-            }
-        }
-    } catch (const std::exception& e) {
-        spdlog::error("Error parsing pilot slurper position: %s", e.what());
+    done(found, latitude, longitude);
+}
+void vector_audio::vatsim::DataHandler::pollDatafileChanges()
+{
+    DatafileSnapshot snapshot;
+    auto res = this->streamDatafile({ "pilots", "controllers" },
+        [&snapshot](const std::string& array, const nlohmann::json& element) {
+            snapshot.add(array, element);
+            return false;
+        },
+        [&snapshot] { snapshot = DatafileSnapshot(); });
+
+    if (res != StreamResult::Failed) {
+        this->publishChanges(std::move(snapshot));
+    }
+}
+std::optional<bool>
+vector_audio::vatsim::DataHandler::getConnectionStatusWithSlurper(
+    SessionInfo& session)
+{
+    if (!this->isSlurperAvailable()) {
+        return false;
     }
 
-    return false;
+    if (shared::vatsim_cid == 0) {
+        return false;
+    }
+
+    std::string url_with_params
+        = endpoints_.slurper_path + std::to_string(shared::vatsim_cid);
+    int status = 0;
+    auto res = this->downloadString(
+        endpoints_.slurper_server, url_with_params, status);
+
+    // The slurper answers an empty body when we are not connected, a failed
+    // download looks the same
+    if (status != 200) {
+        return std::nullopt;
+    }
+
+    return this->parseSlurper(res, session);
 }
-bool vector_audio::vatsim::DataHandler::getPilotPositionWithDatafile(
-    const std::string& callsign, double& latitude, double& longitude)
+std::optional<bool>
+vector_audio::vatsim::DataHandler::getConnectionStatusWithDatafile(
+    SessionInfo& session)
 {
     if (!this->isDatafileAvailable()) {
         return false;
     }
 
-    auto cli = httplib::Client(this->datafile_host_);
-    std::string res = vector_audio::vatsim::DataHandler::downloadString(
-        cli, this->datafile_url_);
+    std::optional<DatafileSnapshot> snapshot;
+    if (this->hasChangeHandlers()) {
+        snapshot.emplace();
+    }
 
-    if (res.empty()) {
-        return false;
+    std::vector<std::string> arrays { "controllers" };
+    if (snapshot) {
+        arrays.emplace_back("pilots");
     }
 
-    try {
-        if (!nlohmann::json::accept(res)) {
-            spdlog::error("Failed to parse pilot datafile: not valid JSON");
-            return false;
-        }
+    bool found = false;
+    bool connected = false;
+    auto res = this->streamDatafile(
+        arrays, sessionHandler(snapshot, found, connected, session),
+        [&] {
+            if (snapshot) {
+                snapshot.emplace();
+            }
+            found = false;
+            connected = false;
+        },
+        true);
 
-        auto v3_datafile = nlohmann::json::parse(res);
+    if (res == StreamResult::Failed) {
+        return std::nullopt;
+    }
 
-        for (auto pilot : v3_datafile["pilots"]) {
-            if (pilot["callsign"] == callsign) {
+    if (snapshot) {
+        this->publishChanges(std::move(*snapshot));
+    }
 
-                latitude = pilot["latitude"].get<double>();
-                longitude = pilot["longitude"].get<double>();
+    return found && connected;
+}
+bool vector_audio::vatsim::DataHandler::getPilotPositionWithSlurper(
+    const std::string& callsign, double& latitude, double& longitude)
+{
+    if (!this->isSlurperAvailable()) {
+        return false;
+    }
 
-                return true;
-            }
-        }
-    } catch (const std::exception& e) {
-        spdlog::error("Failed to parse pilot datafile: %s", e.what());
+    std::string res;
+    std::string url_with_params = endpoints_.slurper_path + callsign;
+    res = vector_audio::vatsim::DataHandler::downloadString(
+        endpoints_.slurper_server, url_with_params);
+
+    return parsers::parsePilotPositionFromSlurper(res, latitude, longitude);
+}
+bool vector_audio::vatsim::DataHandler::getPilotPositionWithDatafile(
+    const std::string& callsign, double& latitude, double& longitude)
+{
+    if (!this->isDatafileAvailable()) {
+        return false;
     }
 
-    return false;
+    auto res = this->streamDatafile({ "pilots" },
+        [&](const std::string& /*array*/, const nlohmann::json& pilot) {
+            return parsers::matchPilot(pilot, callsign, latitude, longitude);
+        });
+
+    return res == StreamResult::Found;
 }
 bool vector_audio::vatsim::DataHandler::getPilotPositionWithAnything(
     const std::string& callsign, double& latitude, double& longitude)
@@ -0,0 +1,85 @@
+#include "datafile_diff.h"
+#include "util.h"
+
+namespace vector_audio::vatsim {
+
+const char* changeTypeName(ChangeType type)
+{
+    switch (type) {
+    case ChangeType::Added:
+        return "added";
+    case ChangeType::Removed:
+        return "removed";
+    case ChangeType::Moved:
+        return "moved";
+    case ChangeType::FrequencyChanged:
+        return "frequency";
+    }
+
+    return "unknown";
+}
+
+void DatafileSnapshot::add(
+    const std::string& array, const nlohmann::json& element)
+{
+    auto callsign = element.find("callsign");
+    if (callsign == element.end() || !callsign->is_string()) {
+        return;
+    }
+
+    NetworkEntry entry;
+    entry.callsign = callsign->get<std::string>();
+    entry.cid = element.value("cid", 0);
+
+    if (array == "controllers") {
+        entry.is_controller = true;
+        auto frequency = element.value("frequency", std::string());
+        entry.frequency
+            = util::cleanUpFrequency(util::frequencyFromMHz(frequency));
+    } else if (array == "pilots") {
+        entry.latitude = element.value("latitude", 0.0);
+        entry.longitude = element.value("longitude", 0.0);
+    } else {
+        return;
+    }
+
+    auto key = entry.callsign;
+    entries_.insert_or_assign(std::move(key), std::move(entry));
+}
+
+std::vector<DatafileChange> DatafileSnapshot::diff(
+    const DatafileSnapshot& before) const
+{
+    std::vector<DatafileChange> changes;
+
+    for (const auto& [callsign, entry] : entries_) {
+        auto it = before.entries_.find(callsign);
+        if (it == before.entries_.end()) {
+            changes.push_back({ ChangeType::Added, entry });
+            continue;
+        }
+
+        const auto& old = it->second;
+        if (old.is_controller != entry.is_controller) {
+            changes.push_back({ ChangeType::Removed, old });
+            changes.push_back({ ChangeType::Added, entry });
+        } else if (entry.is_controller && old.frequency != entry.frequency) {
+            changes.push_back(
+                { ChangeType::FrequencyChanged, entry, old.frequency });
+        } else if (!entry.is_controller
+            && (old.latitude != entry.latitude
+                || old.longitude != entry.longitude)) {
+            changes.push_back({ ChangeType::Moved, entry });
+        }
+    }
+
+    for (const auto& [callsign, old] : before.entries_) {
+        if (entries_.find(callsign) == entries_.end()) {
+            changes.push_back({ ChangeType::Removed, old });
+        }
+    }
+
+    return changes;
+}
+
+}
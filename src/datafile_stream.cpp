@@ -0,0 +1,204 @@
+#include "datafile_stream.h"
+#include <algorithm>
+#include <spdlog/spdlog.h>
+#include <utility>
+
+namespace vector_audio::vatsim {
+
+ChunkPipe::ChunkPipe(std::size_t max_buffered)
+    : max_buffered_(max_buffered)
+{
+}
+
+bool ChunkPipe::write(const char* data, std::size_t size)
+{
+    std::unique_lock<std::mutex> lk(m_);
+    // A single chunk larger than the limit still goes through on its own
+    cv_.wait(lk, [this] { return stopped_ || buffered_ < max_buffered_; });
+    if (stopped_) {
+        return false;
+    }
+
+    chunks_.emplace_back(data, size);
+    buffered_ += size;
+    cv_.notify_all();
+    return true;
+}
+
+void ChunkPipe::close()
+{
+    const std::lock_guard<std::mutex> lock(m_);
+    closed_ = true;
+    cv_.notify_all();
+}
+
+void ChunkPipe::stop()
+{
+    const std::lock_guard<std::mutex> lock(m_);
+    stopped_ = true;
+    chunks_.clear();
+    buffered_ = 0;
+    cv_.notify_all();
+}
+
+ChunkPipe::int_type ChunkPipe::underflow()
+{
+    if (gptr() < egptr()) {
+        return traits_type::to_int_type(*gptr());
+    }
+
+    {
+        std::unique_lock<std::mutex> lk(m_);
+        cv_.wait(lk, [this] { return !chunks_.empty() || closed_; });
+        if (chunks_.empty()) {
+            return traits_type::eof();
+        }
+
+        current_ = std::move(chunks_.front());
+        chunks_.pop_front();
+        buffered_ -= current_.size();
+        cv_.notify_all();
+    }
+
+    setg(current_.data(), current_.data(), current_.data() + current_.size());
+    return traits_type::to_int_type(*gptr());
+}
+
+DatafileSax::DatafileSax(
+    std::vector<std::string> arrays, ElementHandler handler)
+    : arrays_(std::move(arrays))
+    , handler_(std::move(handler))
+{
+}
+
+nlohmann::json* DatafileSax::insert(nlohmann::json&& value)
+{
+    auto* parent = stack_.back();
+    if (parent->is_array()) {
+        parent->push_back(std::move(value));
+        return &parent->back();
+    }
+
+    auto& slot = (*parent)[key_];
+    slot = std::move(value);
+    return &slot;
+}
+
+bool DatafileSax::value(nlohmann::json&& value)
+{
+    // Scalars are only kept inside the element being built
+    if (building()) {
+        insert(std::move(value));
+    }
+    return true;
+}
+
+bool DatafileSax::null() { return value(nullptr); }
+
+bool DatafileSax::boolean(bool val) { return value(val); }
+
+bool DatafileSax::number_integer(number_integer_t val) { return value(val); }
+
+bool DatafileSax::number_unsigned(number_unsigned_t val)
+{
+    return value(val);
+}
+
+bool DatafileSax::number_float(number_float_t val, const string_t& /*s*/)
+{
+    return value(val);
+}
+
+bool DatafileSax::string(string_t& val) { return value(std::move(val)); }
+
+bool DatafileSax::binary(binary_t& val)
+{
+    return value(nlohmann::json::binary(std::move(val)));
+}
+
+bool DatafileSax::start_object(std::size_t /*elements*/)
+{
+    depth_++;
+
+    if (building()) {
+        stack_.push_back(insert(nlohmann::json::object()));
+    } else if (in_array_ && depth_ == 3) {
+        element_ = nlohmann::json::object();
+        stack_.push_back(&element_);
+    }
+    return true;
+}
+
+bool DatafileSax::key(string_t& val)
+{
+    if (building()) {
+        key_ = std::move(val);
+    } else if (depth_ == 1) {
+        top_key_ = std::move(val);
+    }
+    return true;
+}
+
+bool DatafileSax::end_object()
+{
+    depth_--;
+
+    if (!building()) {
+        return true;
+    }
+
+    stack_.pop_back();
+    if (building()) {
+        return true;
+    }
+
+    // A malformed element only costs that element, the rest of the datafile
+    // is still good. Returning false from a SAX event ends the parse early.
+    try {
+        if (handler_(top_key_, element_)) {
+            found_ = true;
+            return false;
+        }
+    } catch (nlohmann::json::exception& ex) {
+        spdlog::warn("Skipping a malformed entry in {}: {}", top_key_,
+            ex.what());
+    }
+    return true;
+}
+
+bool DatafileSax::start_array(std::size_t /*elements*/)
+{
+    depth_++;
+
+    if (building()) {
+        stack_.push_back(insert(nlohmann::json::array()));
+    } else if (depth_ == 2
+        && std::find(arrays_.begin(), arrays_.end(), top_key_)
+            != arrays_.end()) {
+        in_array_ = true;
+    }
+    return true;
+}
+
+bool DatafileSax::end_array()
+{
+    if (building()) {
+        stack_.pop_back();
+    } else if (depth_ == 2) {
+        in_array_ = false;
+    }
+
+    depth_--;
+    return true;
+}
+
+bool DatafileSax::parse_error(std::size_t position,
+    const std::string& /*last_token*/, const nlohmann::detail::exception& ex)
+{
+    spdlog::error("Failed to parse datafile at byte {}: {}", position,
+        ex.what());
+    failed_ = true;
+    return false;
+}
+
+}
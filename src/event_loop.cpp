@@ -0,0 +1,48 @@
+#include "event_loop.h"
+#include <exception>
+#include <spdlog/spdlog.h>
+
+namespace vector_audio {
+
+EventLoop::EventLoop(std::size_t threads, std::size_t blocking_threads)
+    : work_(restinio::asio_ns::make_work_guard(context_))
+    , blocking_(blocking_threads)
+{
+    for (std::size_t i = 0; i < threads; i++) {
+        threads_.emplace_back([this] {
+            // A handler that throws would otherwise take the whole app down
+            for (;;) {
+                try {
+                    context_.run();
+                    return;
+                } catch (std::exception& ex) {
+                    spdlog::error("Unhandled error in the network loop: {}",
+                        ex.what());
+                }
+            }
+        });
+    }
+
+    spdlog::debug("Started the network loop with {} threads, and {} for "
+                  "blocking calls",
+        threads, blocking_threads);
+}
+
+EventLoop::~EventLoop()
+{
+    // Whatever is still queued is dropped, the owners of the handlers have
+    // waited for the ones that matter
+    work_.reset();
+    context_.stop();
+
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    blocking_.stop();
+    blocking_.join();
+}
+
+}
@@ -0,0 +1,83 @@
+#include "headless.h"
+#include "app_core.h"
+#include "replay.h"
+#include "shared.h"
+#include <chrono>
+#include <csignal>
+#include <memory>
+#include <spdlog/fmt/chrono.h>
+#include <spdlog/spdlog.h>
+#include <thread>
+
+namespace vector_audio {
+
+namespace {
+    using namespace std::chrono_literals;
+
+    // Short enough for the SDK transmitting data to stay fresh
+    constexpr auto kTickInterval = 50ms;
+    // How long to wait before retrying a failed connection
+    constexpr auto kReconnectDelay = 30s;
+
+    volatile std::sig_atomic_t g_stop_requested = 0;
+
+    void requestStop(int /*signal*/) { g_stop_requested = 1; }
+}
+
+int run_headless(const std::string& replay_path)
+{
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+
+    spdlog::info("Starting VectorAudio in headless mode...");
+
+    auto core = std::make_unique<application::AppCore>();
+    if (core->client() == nullptr) {
+        spdlog::critical("Cannot run headless without an AFV client");
+        return 1;
+    }
+
+    std::unique_ptr<replay::ReplayDriver> replay_driver;
+    if (!replay_path.empty()) {
+        replay_driver
+            = std::make_unique<replay::ReplayDriver>(replay_path, *core);
+        spdlog::info("Replaying {}", replay_path);
+    }
+
+    auto next_connect_attempt = std::chrono::steady_clock::now();
+    while (g_stop_requested == 0) {
+        if (replay_driver && !replay_driver->advance(kTickInterval)) {
+            break;
+        }
+
+        core->tick();
+
+        // There is nobody to press Connect, so we follow the VATSIM session.
+        // Replays only feed the recorded events and never connect for real.
+        auto now = std::chrono::steady_clock::now();
+        if (!shared::offlineMode && shared::session::is_connected
+            && !core->isConnected() && now >= next_connect_attempt) {
+            spdlog::info("Connecting to AFV as {}", shared::session::callsign);
+            core->connect();
+            next_connect_attempt = now + kReconnectDelay;
+        }
+
+        std::this_thread::sleep_for(kTickInterval);
+    }
+
+    spdlog::info("Stopping VectorAudio...");
+    if (core->isConnected()) {
+        core->disconnect(true);
+    }
+
+    auto shutdown_start = std::chrono::steady_clock::now();
+    replay_driver.reset();
+    core.reset();
+    spdlog::info("Background work stopped in {}",
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - shutdown_start));
+
+    return 0;
+}
+
+}
@@ -1,4 +1,6 @@
+#include <charconv>
 #include <cstdio>
+#include <cstdlib>
 
 #include <SFML/Graphics/RenderWindow.hpp>
 #include <SFML/System/Clock.hpp>
@@ -7,107 +9,257 @@
 #include <filesystem>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <thread>
-#include <random>
 
 #include "application.h"
 #include "config.h"
 #include "data_file_handler.h"
+#include "headless.h"
+#include "mock_afv_client.h"
 #include "imgui-SFML.h"
 #include "imgui.h"
+#include "profiler.h"
+#include "replay.h"
 #include "shared.h"
 #include "single_instance.h"
+#include "startup.h"
+#include "spdlog/fmt/chrono.h"
 #include "spdlog/spdlog.h"
 #include "style.h"
 #include "updater.h"
 #include "window_manager.h"
 
+namespace {
+// Far more than any VCCS lists, a typo rather than a load test above that
+constexpr int kMaxMockStations = 1000;
+
+// Settings may be open with edits the user has not saved yet, so only the
+// captured PTT is written
+void save_ptt_settings()
+{
+    vector_audio::Configuration::save_setting("user", "ptt");
+    vector_audio::Configuration::save_setting("user", "joyStickId");
+    vector_audio::Configuration::save_setting("user", "joyStickPtt");
+}
+}
+
 // Main code
-int main(int, char**)
+int main(int argc, char** argv)
 {
+    bool headless = false;
+    std::string instance_name;
+    std::string_view sdk_port;
+    std::string record_path;
+    std::string replay_path;
+    std::string_view mock_client;
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg(argv[i]);
+        if (arg == "--headless") {
+            headless = true;
+        } else if (arg == "--instance" && i + 1 < argc) {
+            instance_name = argv[++i];
+        } else if (arg == "--sdk-port" && i + 1 < argc) {
+            sdk_port = argv[++i];
+        } else if (arg == "--record" && i + 1 < argc) {
+            record_path = argv[++i];
+        } else if (arg == "--replay" && i + 1 < argc) {
+            replay_path = argv[++i];
+        } else if (arg == "--mock-client" && i + 1 < argc) {
+            mock_client = argv[++i];
+        }
+    }
+
+    if (!instance_name.empty()
+        && !vector_audio::Configuration::set_instance_name(instance_name)) {
+        std::fprintf(stderr, "Invalid instance name: %s\n", instance_name.c_str());
+        return 1;
+    }
+
+    int port = 0;
+    if (!sdk_port.empty()) {
+        const auto* end = sdk_port.data() + sdk_port.size();
+        auto [ptr, ec] = std::from_chars(sdk_port.data(), end, port);
+        if (ec != std::errc() || ptr != end || port < 1 || port > 65535) {
+            std::fprintf(stderr, "Invalid SDK port, expected 1 to 65535: %.*s\n",
+                static_cast<int>(sdk_port.size()), sdk_port.data());
+            return 1;
+        }
+    }
 
-    std::srand(time(nullptr));
+    int mock_stations = -1;
+    if (!mock_client.empty()) {
+        const auto* end = mock_client.data() + mock_client.size();
+        auto [ptr, ec] = std::from_chars(mock_client.data(), end, mock_stations);
+        if (ec != std::errc() || ptr != end || mock_stations < 0 || mock_stations > kMaxMockStations) {
+            std::fprintf(stderr, "Invalid mock client stations, expected 0 to %d: %.*s\n",
+                kMaxMockStations, static_cast<int>(mock_client.size()), mock_client.data());
+            return 1;
+        }
+    }
 
-    vector_audio::SingleInstance instance;
+    vector_audio::Startup startup;
+
+    vector_audio::SingleInstance instance(instance_name);
     if (instance.HasRunningInstance()) {
         return 0;
     }
 
     vector_audio::Configuration::build_logger();
-    sf::RenderWindow window(sf::VideoMode(800, 600), "VectorAudio");
-    window.setFramerateLimit(30);
+    if (!instance_name.empty()) {
+        spdlog::info("Using instance profile {}", instance_name);
+    }
+
+    // Each instance keeps its SDK port in its own config, the flag sets it
+    // once for the profile. Only the port is written, not every setting.
+    auto apply_sdk_port = [port]() {
+        if (port > 0) {
+            vector_audio::shared::apiServerPort = port;
+            vector_audio::Configuration::save_setting("general", "api_port");
+        }
+    };
+
+    if (!record_path.empty()) {
+        vector_audio::replay::Recorder::start(record_path);
+    }
+    vector_audio::shared::offlineMode = !replay_path.empty() || mock_stations >= 0;
+
+    if (headless) {
+        vector_audio::Configuration::build_config();
+        apply_sdk_port();
+        int exit_code = vector_audio::run_headless(replay_path);
+        vector_audio::replay::Recorder::stop();
+        vector_audio::Configuration::stop_config_writer();
+        return exit_code;
+    }
+
+    // The config does not need the window, so it is parsed while the window
+    // and the font atlas are being built
+    startup.start("config", &vector_audio::Configuration::build_config);
+
+    sf::RenderWindow window;
+    startup.run("window", [&]() {
+        std::string title = "VectorAudio";
+        if (!instance_name.empty()) {
+            title += " - " + instance_name;
+        }
+        window.create(sf::VideoMode(800, 600), title);
+        window.setFramerateLimit(30);
 
-    auto image = sf::Image {};
+        auto image = sf::Image {};
 
 #ifdef SFML_SYSTEM_WINDOWS
-    std::string icon_name = "icon_win.png";
+        std::string icon_name = "icon_win.png";
 #else
-    std::string icon_name = "icon_mac.png";
+        std::string icon_name = "icon_mac.png";
 #endif
 
-    if (!image.loadFromFile((vector_audio::Configuration::get_resource_folder() / icon_name).string())) {
-        spdlog::error("Could not load application icon");
-    } else {
-        window.setIcon(image.getSize().x, image.getSize().y, image.getPixelsPtr());
-    }
-
-    if (!ImGui::SFML::Init(window, false)) {
-        spdlog::critical("Could not initialise ImGui SFML");
-    }
-
-    // Setup Dear ImGui context
-    IMGUI_CHECKVERSION();
-    ImGui::CreateContext();
-    ImGuiIO& io = ImGui::GetIO();
-    (void)io;
-    // io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;     // Enable
-    // Keyboard Controls io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad; //
-    // Enable Gamepad Controls
-
-    // Setup Dear ImGui style
-    ImGui::StyleColorsDark();
-    // ImGui::StyleColorsClassic();
-
-    // Load Fonts
-    // - If no fonts are loaded, dear imgui will use the default font. You can
-    // also load multiple fonts and use ImGui::PushFont()/PopFont() to select
-    // them.
-    // - AddFontFromFileTTF() will return the ImFont* so you can store it if you
-    // need to select the font among multiple.
-    // - If the file cannot be loaded, the function will return NULL. Please
-    // handle those errors in your application (e.g. use an assertion, or display
-    // an error and quit).
-    // - The fonts will be rasterized at a given size (w/ oversampling) and stored
-    // into a texture when calling ImFontAtlas::Build()/GetTexDataAsXXXX(), which
-    // ImGui_ImplXXXX_NewFrame below will call.
-    // - Read 'docs/FONTS.md' for more instructions and details.
-    // - Remember that in C/C++ if you want to include a backslash \ in a string
-    // literal you need to write a double backslash \\ !
-    // io.Fonts->AddFontDefault();
-    std::filesystem::path p = vector_audio::Configuration::get_resource_folder() / std::filesystem::path("JetBrainsMono-Regular.ttf");
-    io.Fonts->AddFontFromFileTTF(p.string().c_str(), 18.0);
-
-    if (!ImGui::SFML::UpdateFontTexture()) {
-        spdlog::critical("Could not update font textures");
-    };
+        if (!image.loadFromFile((vector_audio::Configuration::get_resource_folder() / icon_name).string())) {
+            spdlog::error("Could not load application icon");
+        } else {
+            window.setIcon(image.getSize().x, image.getSize().y, image.getPixelsPtr());
+        }
+    });
 
-    // Our state
+    startup.run("imgui", [&]() {
+        if (!ImGui::SFML::Init(window, false)) {
+            spdlog::critical("Could not initialise ImGui SFML");
+        }
 
-    vector_audio::style::apply_style();
-    vector_audio::Configuration::build_config();
+        // Setup Dear ImGui context
+        IMGUI_CHECKVERSION();
+        ImGui::CreateContext();
+        ImGuiIO& io = ImGui::GetIO();
+        (void)io;
+        // io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;     // Enable
+        // Keyboard Controls io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad; //
+        // Enable Gamepad Controls
+
+        // Setup Dear ImGui style
+        ImGui::StyleColorsDark();
+        // ImGui::StyleColorsClassic();
+
+        // Load Fonts
+        // - If no fonts are loaded, dear imgui will use the default font. You can
+        // also load multiple fonts and use ImGui::PushFont()/PopFont() to select
+        // them.
+        // - AddFontFromFileTTF() will return the ImFont* so you can store it if you
+        // need to select the font among multiple.
+        // - If the file cannot be loaded, the function will return NULL. Please
+        // handle those errors in your application (e.g. use an assertion, or display
+        // an error and quit).
+        // - The fonts will be rasterized at a given size (w/ oversampling) and stored
+        // into a texture when calling ImFontAtlas::Build()/GetTexDataAsXXXX(), which
+        // ImGui_ImplXXXX_NewFrame below will call.
+        // - Read 'docs/FONTS.md' for more instructions and details.
+        // - Remember that in C/C++ if you want to include a backslash \ in a string
+        // literal you need to write a double backslash \\ !
+        // io.Fonts->AddFontDefault();
+        std::filesystem::path p = vector_audio::Configuration::get_resource_folder() / std::filesystem::path("JetBrainsMono-Regular.ttf");
+        io.Fonts->AddFontFromFileTTF(p.string().c_str(), 18.0);
+
+        if (!ImGui::SFML::UpdateFontTexture()) {
+            spdlog::critical("Could not update font textures");
+        };
+
+        vector_audio::style::apply_style();
+    });
+
+    startup.wait("config");
+    apply_sdk_port();
 
     spdlog::info("Starting VectorAudio...");
 
-    auto updater_instance = std::make_unique<vector_audio::updater>();
+    std::unique_ptr<vector_audio::updater> updater_instance;
+    startup.run("updater", [&]() {
+        updater_instance = std::make_unique<vector_audio::updater>();
+    });
+
+    // The mock client stands in for afv_native, to benchmark or replay the
+    // app without the audio and network stack
+    vector_audio::MockAfvClient* mock_client = nullptr;
+    std::unique_ptr<vector_audio::application::App> current_app;
+    startup.run("app", [&]() {
+        std::unique_ptr<vector_audio::AfvClient> client;
+        if (mock_stations >= 0) {
+            vector_audio::MockAfvClient::Options options;
+            options.stations = mock_stations;
+            auto mock = std::make_unique<vector_audio::MockAfvClient>(options);
+            mock_client = mock.get();
+            client = std::move(mock);
+            spdlog::info("Using a mock afv client with {} stations", mock_stations);
+
+            // Without a replay there is no VATSIM data, so the mock gets a
+            // session of its own to connect with
+            if (replay_path.empty()) {
+                const std::lock_guard<std::mutex> lock(vector_audio::shared::session::m);
+                vector_audio::shared::session::is_connected = true;
+                vector_audio::shared::session::callsign = "MOCK_CTR";
+                vector_audio::shared::session::frequency = 118000000;
+                vector_audio::shared::session::facility = 6;
+            }
+        }
+
+        current_app = std::make_unique<vector_audio::application::App>(std::move(client));
+    });
 
-    auto current_app = std::make_unique<vector_audio::application::App>();
+    // Replays run on a virtual clock of one frame per loop, at the frame
+    // limit, so they behave the same however long the frames take
+    std::unique_ptr<vector_audio::replay::ReplayDriver> replay_driver;
+    if (!replay_path.empty()) {
+        replay_driver = std::make_unique<vector_audio::replay::ReplayDriver>(replay_path, current_app->core());
+        spdlog::info("Replaying {}", replay_path);
+    }
 
     bool always_on_top = vector_audio::shared::keepWindowOnTop;
     vector_audio::setAlwaysOnTop(window, always_on_top);
 
     // Main loop
     sf::Clock delta_clock;
+    bool first_frame = true;
     while (window.isOpen()) {
+        vector_audio::Profiler::begin_frame();
+
         // Poll and handle events (inputs, window resize, etc.)
         // You can read the io.WantCaptureMouse, io.WantCaptureKeyboard flags to
         // tell if dear imgui wants to use your inputs.
@@ -117,6 +269,7 @@ int main(int, char**)
         // data to your main application. Generally you may always pass all inputs
         // to dear imgui, and hide them from your application based on those two
         // flags.
+        vector_audio::Profiler::Scope events_scope("Event polling");
         sf::Event event;
         while (window.pollEvent(event)) {
             ImGui::SFML::ProcessEvent(window, event);
@@ -130,11 +283,11 @@ int main(int, char**)
 
                     vector_audio::shared::joyStickId = -1;
                     vector_audio::shared::joyStickPtt = -1;
-                    vector_audio::Configuration::config_["user"]["joyStickId"] = vector_audio::shared::joyStickId;
-                    vector_audio::Configuration::config_["user"]["joyStickPtt"] = vector_audio::shared::joyStickPtt;
-                    vector_audio::Configuration::config_["user"]["ptt"] = static_cast<int>(vector_audio::shared::ptt);
-                    vector_audio::Configuration::write_config_async();
+                    save_ptt_settings();
                     vector_audio::shared::capture_ptt_flag = false;
+                } else if (event.key.control && event.key.shift
+                    && event.key.code == sf::Keyboard::P) {
+                    vector_audio::Profiler::toggle();
                 }
             } else if (event.type == sf::Event::JoystickButtonPressed) {
 
@@ -144,10 +297,7 @@ int main(int, char**)
                     vector_audio::shared::joyStickId = event.joystickButton.joystickId;
                     vector_audio::shared::joyStickPtt = event.joystickButton.button;
 
-                    vector_audio::Configuration::config_["user"]["joyStickId"] = vector_audio::shared::joyStickId;
-                    vector_audio::Configuration::config_["user"]["joyStickPtt"] = vector_audio::shared::joyStickPtt;
-                    vector_audio::Configuration::config_["user"]["ptt"] = static_cast<int>(vector_audio::shared::ptt);
-                    vector_audio::Configuration::write_config_async();
+                    save_ptt_settings();
                     vector_audio::shared::capture_ptt_flag = false;
                 }
             }
@@ -158,21 +308,54 @@ int main(int, char**)
             }
         }
 
-        ImGui::SFML::Update(window, delta_clock.restart());
+        events_scope.end();
 
-        if (!updater_instance->need_update())
-            current_app->render_frame();
-        else
-            updater_instance->draw();
+        {
+            vector_audio::Profiler::Scope scope("ImGui::SFML::Update");
+            ImGui::SFML::Update(window, delta_clock.restart());
+        }
+
+        constexpr auto frame_step = std::chrono::microseconds(1000000 / 30);
+        if (replay_driver) {
+            replay_driver->advance(frame_step);
+        }
+        if (mock_client != nullptr) {
+            mock_client->advance(frame_step);
+        }
+
+        current_app->render_frame();
+        updater_instance->draw();
+        vector_audio::Profiler::draw();
 
         // ImGui::ShowDemoWindow(NULL);
 
         // Rendering
         window.clear();
-        ImGui::SFML::Render(window);
+        {
+            vector_audio::Profiler::Scope scope("ImGui::SFML::Render");
+            ImGui::SFML::Render(window);
+        }
         window.display();
+
+        vector_audio::Profiler::end_frame();
+
+        if (first_frame) {
+            startup.log_summary("First frame displayed");
+            first_frame = false;
+        }
     }
 
+    // Everything running in the background is stopped and joined here, in
+    // order, rather than whenever the destructors happen to run
+    auto shutdown_start = std::chrono::steady_clock::now();
+    replay_driver.reset();
+    current_app.reset();
+    updater_instance.reset();
+    spdlog::info("Background work stopped in {}", std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - shutdown_start));
+
+    vector_audio::replay::Recorder::stop();
+    vector_audio::Configuration::stop_config_writer();
+
     ImGui::SFML::Shutdown();
 
     return 0;
@@ -0,0 +1,440 @@
+#include "mock_afv_client.h"
+#include <functional>
+#include <spdlog/fmt/fmt.h>
+#include <thread>
+#include <utility>
+
+namespace vector_audio {
+
+namespace {
+    // 25kHz channels from 118.000 up to 136.975
+    constexpr unsigned int kFirstFrequency = 118000000;
+    constexpr unsigned int kChannelSpacing = 25000;
+    constexpr unsigned int kChannelCount = 760;
+
+    unsigned int stationFrequency(std::uint32_t index)
+    {
+        return kFirstFrequency + (index % kChannelCount) * kChannelSpacing;
+    }
+
+    std::string stationCallsign(int index)
+    {
+        return fmt::format("MOCK{:03}_CTR", index);
+    }
+
+    std::uint32_t nameHash(const std::string& name)
+    {
+        return static_cast<std::uint32_t>(std::hash<std::string> {}(name));
+    }
+}
+
+MockAfvClient::MockAfvClient(Options options)
+    : options_(options)
+{
+}
+
+void MockAfvClient::advance(std::chrono::microseconds step)
+{
+    const std::lock_guard<std::mutex> lock(m_);
+    now_ += step;
+}
+
+void MockAfvClient::simulateLatency() const
+{
+    if (options_.call_latency.count() > 0) {
+        std::this_thread::sleep_for(options_.call_latency);
+    }
+}
+
+void MockAfvClient::raise(
+    afv_native::ClientEventType evt, void* data, void* data2)
+{
+    ClientEventCallback callback;
+    {
+        const std::lock_guard<std::mutex> lock(m_);
+        callback = callback_;
+    }
+
+    if (callback) {
+        callback(evt, data, data2);
+    }
+}
+
+std::uint32_t MockAfvClient::hash(
+    std::uint32_t value, std::int64_t window) const
+{
+    // splitmix style mixing, cheap and good enough to spread the traffic
+    auto x = static_cast<std::uint64_t>(value) * 0x9E3779B97F4A7C15ULL
+        ^ static_cast<std::uint64_t>(window) * 0xBF58476D1CE4E5B9ULL
+        ^ options_.seed;
+    x ^= x >> 31;
+    x *= 0x94D049BB133111EBULL;
+    x ^= x >> 29;
+    return static_cast<std::uint32_t>(x);
+}
+
+std::int64_t MockAfvClient::currentWindow() const
+{
+    return now_ / options_.transmission_length;
+}
+
+std::string MockAfvClient::transmitterIn(
+    unsigned int freq, std::int64_t window) const
+{
+    auto h = hash(freq, window);
+    if (static_cast<double>(h % 1000) >= options_.rx_activity * 1000.0) {
+        return "";
+    }
+
+    return fmt::format("MCK{}", h % 1000);
+}
+
+void MockAfvClient::SetCredentials(
+    std::string /*username*/, std::string /*password*/)
+{
+    simulateLatency();
+}
+
+void MockAfvClient::SetCallsign(std::string /*callsign*/)
+{
+    simulateLatency();
+}
+
+void MockAfvClient::SetClientPosition(
+    double /*lat*/, double /*lon*/, double /*amslm*/, double /*aglm*/)
+{
+    simulateLatency();
+}
+
+bool MockAfvClient::IsVoiceConnected()
+{
+    simulateLatency();
+    const std::lock_guard<std::mutex> lock(m_);
+    return voice_connected_;
+}
+
+bool MockAfvClient::IsAPIConnected()
+{
+    simulateLatency();
+    const std::lock_guard<std::mutex> lock(m_);
+    return api_connected_;
+}
+
+bool MockAfvClient::Connect()
+{
+    simulateLatency();
+    {
+        const std::lock_guard<std::mutex> lock(m_);
+        api_connected_ = true;
+        voice_connected_ = true;
+    }
+
+    raise(afv_native::ClientEventType::APIServerConnected);
+    raise(afv_native::ClientEventType::VoiceServerConnected);
+    return true;
+}
+
+void MockAfvClient::Disconnect()
+{
+    simulateLatency();
+    {
+        const std::lock_guard<std::mutex> lock(m_);
+        if (!api_connected_ && !voice_connected_) {
+            return;
+        }
+
+        api_connected_ = false;
+        voice_connected_ = false;
+        frequencies_.clear();
+    }
+
+    raise(afv_native::ClientEventType::VoiceServerDisconnected);
+    raise(afv_native::ClientEventType::APIServerDisconnected);
+}
+
+void MockAfvClient::SetAudioApi(unsigned int /*api*/) { simulateLatency(); }
+
+std::map<unsigned int, std::string> MockAfvClient::GetAudioApis()
+{
+    simulateLatency();
+    return { { 0, "Mock API" } };
+}
+
+void MockAfvClient::SetAudioInputDevice(std::string /*inputDevice*/)
+{
+    simulateLatency();
+}
+
+std::vector<std::string> MockAfvClient::GetAudioInputDevices(
+    unsigned int /*mAudioApi*/)
+{
+    simulateLatency();
+    return { "Mock Input" };
+}
+
+void MockAfvClient::SetAudioOutputDevice(std::string /*outputDevice*/)
+{
+    simulateLatency();
+}
+
+void MockAfvClient::SetAudioSpeakersOutputDevice(
+    std::string /*outputDevice*/)
+{
+    simulateLatency();
+}
+
+void MockAfvClient::SetHeadsetOutputChannel(int /*channel*/)
+{
+    simulateLatency();
+}
+
+std::vector<std::string> MockAfvClient::GetAudioOutputDevices(
+    unsigned int /*mAudioApi*/)
+{
+    simulateLatency();
+    return { "Mock Output" };
+}
+
+double MockAfvClient::GetInputPeak()
+{
+    simulateLatency();
+    return 0.0;
+}
+
+double MockAfvClient::GetInputVu()
+{
+    simulateLatency();
+    return 0.0;
+}
+
+void MockAfvClient::SetEnableInputFilters(bool /*enableInputFilters*/)
+{
+    simulateLatency();
+}
+
+void MockAfvClient::SetEnableOutputEffects(bool /*enableEffects*/)
+{
+    simulateLatency();
+}
+
+void MockAfvClient::StartAudio()
+{
+    simulateLatency();
+    const std::lock_guard<std::mutex> lock(m_);
+    audio_running_ = true;
+}
+
+void MockAfvClient::StopAudio()
+{
+    simulateLatency();
+    const std::lock_guard<std::mutex> lock(m_);
+    audio_running_ = false;
+}
+
+bool MockAfvClient::IsAudioRunning()
+{
+    simulateLatency();
+    const std::lock_guard<std::mutex> lock(m_);
+    return audio_running_;
+}
+
+void MockAfvClient::SetTx(unsigned int freq, bool active)
+{
+    simulateLatency();
+    const std::lock_guard<std::mutex> lock(m_);
+    auto it = frequencies_.find(freq);
+    if (it != frequencies_.end()) {
+        it->second.tx = active;
+    }
+}
+
+void MockAfvClient::SetRx(unsigned int freq, bool active)
+{
+    simulateLatency();
+    const std::lock_guard<std::mutex> lock(m_);
+    auto it = frequencies_.find(freq);
+    if (it != frequencies_.end()) {
+        it->second.rx = active;
+    }
+}
+
+void MockAfvClient::SetXc(unsigned int freq, bool active)
+{
+    simulateLatency();
+    const std::lock_guard<std::mutex> lock(m_);
+    auto it = frequencies_.find(freq);
+    if (it != frequencies_.end()) {
+        it->second.xc = active;
+    }
+}
+
+void MockAfvClient::SetOnHeadset(unsigned int freq, bool active)
+{
+    simulateLatency();
+    const std::lock_guard<std::mutex> lock(m_);
+    auto it = frequencies_.find(freq);
+    if (it != frequencies_.end()) {
+        it->second.on_headset = active;
+    }
+}
+
+bool MockAfvClient::GetTxActive(unsigned int freq)
+{
+    simulateLatency();
+    const std::lock_guard<std::mutex> lock(m_);
+    auto it = frequencies_.find(freq);
+    return it != frequencies_.end() && it->second.tx && ptt_;
+}
+
+bool MockAfvClient::GetRxActive(unsigned int freq)
+{
+    simulateLatency();
+    const std::lock_guard<std::mutex> lock(m_);
+    auto it = frequencies_.find(freq);
+    return it != frequencies_.end() && it->second.rx
+        && !transmitterIn(freq, currentWindow()).empty();
+}
+
+bool MockAfvClient::GetOnHeadset(unsigned int freq)
+{
+    simulateLatency();
+    const std::lock_guard<std::mutex> lock(m_);
+    auto it = frequencies_.find(freq);
+    return it == frequencies_.end() || it->second.on_headset;
+}
+
+bool MockAfvClient::GetTxState(unsigned int freq)
+{
+    simulateLatency();
+    const std::lock_guard<std::mutex> lock(m_);
+    auto it = frequencies_.find(freq);
+    return it != frequencies_.end() && it->second.tx;
+}
+
+bool MockAfvClient::GetRxState(unsigned int freq)
+{
+    simulateLatency();
+    const std::lock_guard<std::mutex> lock(m_);
+    auto it = frequencies_.find(freq);
+    return it != frequencies_.end() && it->second.rx;
+}
+
+bool MockAfvClient::GetXcState(unsigned int freq)
+{
+    simulateLatency();
+    const std::lock_guard<std::mutex> lock(m_);
+    auto it = frequencies_.find(freq);
+    return it != frequencies_.end() && it->second.xc;
+}
+
+void MockAfvClient::UseTransceiversFromStation(
+    std::string station, int freq)
+{
+    simulateLatency();
+    const std::lock_guard<std::mutex> lock(m_);
+    auto it = frequencies_.find(static_cast<unsigned int>(freq));
+    if (it != frequencies_.end()) {
+        it->second.station = std::move(station);
+    }
+}
+
+void MockAfvClient::FetchTransceiverInfo(std::string station)
+{
+    simulateLatency();
+    raise(afv_native::ClientEventType::StationTransceiversUpdated, &station);
+}
+
+void MockAfvClient::FetchStationVccs(std::string station)
+{
+    simulateLatency();
+
+    std::map<std::string, unsigned int> stations;
+    for (int i = 0; i < options_.stations; i++) {
+        stations.emplace(stationCallsign(i),
+            stationFrequency(static_cast<std::uint32_t>(i)));
+    }
+
+    raise(afv_native::ClientEventType::VccsReceived, &station, &stations);
+}
+
+void MockAfvClient::GetStation(std::string station)
+{
+    simulateLatency();
+
+    bool found = true;
+    std::pair<std::string, unsigned int> result(
+        station, stationFrequency(hash(nameHash(station), 0)));
+    raise(afv_native::ClientEventType::StationDataReceived, &found, &result);
+}
+
+int MockAfvClient::GetTransceiverCountForStation(std::string station)
+{
+    simulateLatency();
+    return 1 + static_cast<int>(hash(nameHash(station), 0) % 5);
+}
+
+void MockAfvClient::SetPtt(bool pttState)
+{
+    simulateLatency();
+    const std::lock_guard<std::mutex> lock(m_);
+    ptt_ = pttState;
+}
+
+void MockAfvClient::StopAtisPlayback() { simulateLatency(); }
+
+bool MockAfvClient::IsAtisPlayingBack()
+{
+    simulateLatency();
+    return false;
+}
+
+std::string MockAfvClient::LastTransmitOnFreq(unsigned int freq)
+{
+    simulateLatency();
+    const std::lock_guard<std::mutex> lock(m_);
+
+    // The current transmission, or else the one just before it
+    auto window = currentWindow();
+    auto callsign = transmitterIn(freq, window);
+    if (callsign.empty()) {
+        callsign = transmitterIn(freq, window - 1);
+    }
+    return callsign;
+}
+
+void MockAfvClient::SetRadiosGain(float /*gain*/) { simulateLatency(); }
+
+void MockAfvClient::AddFrequency(unsigned int freq, std::string stationName)
+{
+    simulateLatency();
+    const std::lock_guard<std::mutex> lock(m_);
+    auto& frequency = frequencies_[freq];
+    frequency.station = std::move(stationName);
+}
+
+void MockAfvClient::RemoveFrequency(unsigned int freq)
+{
+    simulateLatency();
+    const std::lock_guard<std::mutex> lock(m_);
+    frequencies_.erase(freq);
+}
+
+bool MockAfvClient::IsFrequencyActive(unsigned int freq)
+{
+    simulateLatency();
+    const std::lock_guard<std::mutex> lock(m_);
+    return frequencies_.find(freq) != frequencies_.end();
+}
+
+void MockAfvClient::SetHardware(afv_native::HardwareType /*hardware*/)
+{
+    simulateLatency();
+}
+
+void MockAfvClient::RaiseClientEvent(ClientEventCallback callback)
+{
+    const std::lock_guard<std::mutex> lock(m_);
+    callback_ = std::move(callback);
+}
+
+}
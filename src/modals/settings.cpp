@@ -1,7 +1,31 @@
 #include "modals/settings.h"
 #include "data_file_handler.h"
 
-void vector_audio::modals::Settings::render(afv_native::api::atcClient* mClient)
+namespace {
+// The spdlog level names, from the most verbose
+constexpr const char* kLogLevels[] = { "trace", "debug", "info", "warning", "error", "critical", "off" };
+
+// Changes apply right away, so the log can be turned up while reproducing a
+// problem. They are kept like any other setting once saved.
+void logLevelCombo(const char* label, std::string& level)
+{
+    ImGui::PushItemWidth(-1.0F);
+    if (ImGui::BeginCombo(label, level.c_str())) {
+        for (const auto* name : kLogLevels) {
+            if (ImGui::Selectable(name, level == name)) {
+                level = name;
+                vector_audio::Configuration::apply_log_levels();
+            }
+        }
+
+        ImGui::EndCombo();
+    }
+    ImGui::PopItemWidth();
+}
+}
+
+void vector_audio::modals::Settings::render(AfvClient* mClient,
+    AudioDeviceRegistry* audioDevices)
 {
     // Settings modal definition
     if (ImGui::BeginPopupModal("Settings Panel")) {
@@ -148,6 +172,18 @@ void vector_audio::modals::Settings::render(afv_native::api::atcClient* mClient)
             ImGui::SameLine();
             vector_audio::util::HelpMarker("Enable this option to make the VectorAudio\nwindow stay on top of other windows.");
 
+            ImGui::NewLine();
+
+            ImGui::TextUnformatted("Log level");
+            ImGui::SameLine();
+            vector_audio::util::HelpMarker("How much VectorAudio writes to vector_audio.log.\nOnly raise it when reporting a problem.");
+            logLevelCombo("##Log level", vector_audio::shared::logLevel);
+
+            ImGui::TextUnformatted("Audio engine log level");
+            ImGui::SameLine();
+            vector_audio::util::HelpMarker("The same for the afv-native audio engine, which\nlogs far more than VectorAudio itself.");
+            logLevelCombo("##Audio engine log level", vector_audio::shared::afvLogLevel);
+
             ImGui::TableNextColumn();
 
             ImGui::Text("Audio configuration");
@@ -166,11 +202,11 @@ void vector_audio::modals::Settings::render(afv_native::api::atcClient* mClient)
                     if (mClient) {
                         // set the Audio API and update the available inputs and outputs
                         mClient->SetAudioApi(vector_audio::shared::mAudioApi);
-                        vector_audio::shared::availableInputDevices = mClient->GetAudioInputDevices(vector_audio::shared::mAudioApi);
-                        vector_audio::shared::availableOutputDevices = mClient->GetAudioOutputDevices(vector_audio::shared::mAudioApi);
                     }
                     vector_audio::shared::configAudioApi = "Default API";
-                    vector_audio::Configuration::config_["audio"]["api"] = "Default API";
+                    if (audioDevices) {
+                        audioDevices->refresh(vector_audio::shared::configAudioApi);
+                    }
                 }
 
                 // Listing all the devices
@@ -180,11 +216,11 @@ void vector_audio::modals::Settings::render(afv_native::api::atcClient* mClient)
                         if (mClient) {
                             // set the Audio API and update the available inputs and outputs
                             mClient->SetAudioApi(vector_audio::shared::mAudioApi);
-                            vector_audio::shared::availableInputDevices = mClient->GetAudioInputDevices(vector_audio::shared::mAudioApi);
-                            vector_audio::shared::availableOutputDevices = mClient->GetAudioOutputDevices(vector_audio::shared::mAudioApi);
                         }
                         vector_audio::shared::configAudioApi = item.second;
-                        vector_audio::Configuration::config_["audio"]["api"] = item.second;
+                        if (audioDevices) {
+                            audioDevices->refresh(vector_audio::shared::configAudioApi);
+                        }
                     }
                 }
                 ImGui::EndCombo();
@@ -202,7 +238,6 @@ void vector_audio::modals::Settings::render(afv_native::api::atcClient* mClient)
                 for (const auto& driver : m_audio_drivers) {
                     if (ImGui::Selectable(driver.c_str(), vector_audio::shared::configInputDeviceName == driver)) {
                         vector_audio::shared::configInputDeviceName = driver;
-                        vector_audio::Configuration::config_["audio"]["input_device"] = vector_audio::shared::configInputDeviceName;
                     }
                 }
 
@@ -221,7 +256,6 @@ void vector_audio::modals::Settings::render(afv_native::api::atcClient* mClient)
                 for (const auto& driver : m_audio_drivers) {
                     if (ImGui::Selectable(driver.c_str(), vector_audio::shared::configOutputDeviceName == driver)) {
                         vector_audio::shared::configOutputDeviceName = driver;
-                        vector_audio::Configuration::config_["audio"]["output_device"] = vector_audio::shared::configOutputDeviceName;
                     }
                 }
 
@@ -265,7 +299,6 @@ void vector_audio::modals::Settings::render(afv_native::api::atcClient* mClient)
                 for (const auto& driver : m_audio_drivers) {
                     if (ImGui::Selectable(driver.c_str(), vector_audio::shared::configSpeakerDeviceName == driver)) {
                         vector_audio::shared::configSpeakerDeviceName = driver;
-                        vector_audio::Configuration::config_["audio"]["speaker_device"] = vector_audio::shared::configSpeakerDeviceName;
                     }
                 }
 
@@ -313,15 +346,7 @@ void vector_audio::modals::Settings::render(afv_native::api::atcClient* mClient)
 
             vector_audio::style::button_green();
             if (ImGui::Button("Save", ImVec2(ImGui::GetContentRegionAvail().x, 0.0F))) {
-                vector_audio::Configuration::config_["user"]["vatsim_id"] = vector_audio::shared::vatsim_cid;
-                vector_audio::Configuration::config_["user"]["vatsim_password"] = vector_audio::shared::vatsim_password;
-                vector_audio::Configuration::config_["user"]["keepWindowOnTop"] = vector_audio::shared::keepWindowOnTop;
-                vector_audio::Configuration::config_["audio"]["input_filters"] = vector_audio::shared::mInputFilter;
-                vector_audio::Configuration::config_["audio"]["vhf_effects"] = vector_audio::shared::mOutputEffects;
-                vector_audio::Configuration::config_["audio"]["hardware_type"] = static_cast<int>(vector_audio::shared::hardware);
-                vector_audio::Configuration::config_["audio"]["headset_channel"] = vector_audio::shared::headsetOutputChannel;
-
-                vector_audio::Configuration::write_config_async();
+                vector_audio::Configuration::save_settings();
                 if (mClient->IsAudioRunning())
                     mClient->StopAudio();
                 ImGui::CloseCurrentPopup();
@@ -0,0 +1,191 @@
+#include "profiler.h"
+#include "config.h"
+#include "imgui.h"
+#include <algorithm>
+#include <fstream>
+#include <numeric>
+#include <spdlog/spdlog.h>
+
+namespace vector_audio {
+
+Profiler::Scope::Scope(const char* name)
+    : name_(name)
+    , running_(Profiler::enabled_)
+{
+    if (running_) {
+        start_ = clock::now();
+    }
+}
+
+Profiler::Scope::~Scope() { end(); }
+
+void Profiler::Scope::end()
+{
+    if (!running_) {
+        return;
+    }
+
+    running_ = false;
+    Profiler::record(name_, start_, clock::now());
+}
+
+void Profiler::toggle()
+{
+    enabled_ = !enabled_;
+    if (!enabled_) {
+        return;
+    }
+
+    // Start from a clean slate, so stale data from an earlier session does not
+    // end up in the graphs
+    frame_start_ = clock::now();
+    history_index_ = 0;
+    frame_times_.fill(0.0F);
+    phase_times_.clear();
+    events_.clear();
+}
+
+bool Profiler::is_enabled() { return enabled_; }
+
+void Profiler::begin_frame()
+{
+    if (!enabled_) {
+        return;
+    }
+
+    frame_start_ = clock::now();
+}
+
+void Profiler::end_frame()
+{
+    if (!enabled_) {
+        return;
+    }
+
+    auto frame_end = clock::now();
+    record(kFrameEvent, frame_start_, frame_end);
+
+    frame_times_[history_index_]
+        = std::chrono::duration<float, std::milli>(frame_end - frame_start_)
+              .count();
+
+    history_index_ = (history_index_ + 1) % kHistorySize;
+    frame_times_[history_index_] = 0.0F;
+    for (auto& [name, times] : phase_times_) {
+        times[history_index_] = 0.0F;
+    }
+}
+
+void Profiler::record(
+    const char* name, clock::time_point start, clock::time_point end)
+{
+    // Phases can run several times in a frame, they add up
+    if (name != kFrameEvent) {
+        phase_times_[name][history_index_]
+            += std::chrono::duration<float, std::milli>(end - start).count();
+    }
+
+    events_.push_back({ name,
+        std::chrono::duration_cast<std::chrono::microseconds>(start - epoch_)
+            .count(),
+        std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+            .count() });
+
+    if (events_.size() > kMaxEvents) {
+        events_.pop_front();
+    }
+}
+
+void Profiler::draw()
+{
+    if (!enabled_) {
+        return;
+    }
+
+    ImGui::SetNextWindowSize(ImVec2(420.0F, 0.0F), ImGuiCond_FirstUseEver);
+    ImGui::Begin("Profiler", &enabled_, ImGuiWindowFlags_NoSavedSettings);
+
+    // The slot at history_index_ is the frame in progress, so the graph starts
+    // right after it
+    auto max_frame = *std::max_element(frame_times_.begin(), frame_times_.end());
+    auto average_frame
+        = std::accumulate(frame_times_.begin(), frame_times_.end(), 0.0F)
+        / static_cast<float>(kHistorySize);
+
+    ImGui::Text("Frame: avg %.2f ms, max %.2f ms", average_frame, max_frame);
+    ImGui::PlotLines("##Frame times", frame_times_.data(),
+        static_cast<int>(kHistorySize), static_cast<int>(history_index_ + 1),
+        nullptr, 0.0F, std::max(max_frame, 40.0F), ImVec2(-1.0F, 80.0F));
+
+    if (ImGui::BeginTable("profiler_phases", 3,
+            ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Phase");
+        ImGui::TableSetupColumn("Avg (ms)");
+        ImGui::TableSetupColumn("Max (ms)");
+        ImGui::TableHeadersRow();
+
+        for (const auto& [name, times] : phase_times_) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(name);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f",
+                std::accumulate(times.begin(), times.end(), 0.0F)
+                    / static_cast<float>(kHistorySize));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", *std::max_element(times.begin(), times.end()));
+        }
+
+        ImGui::EndTable();
+    }
+
+    if (ImGui::Button("Export Chrome trace")) {
+        auto path = Configuration::get_config_folder_path()
+            / std::filesystem::path("vector_audio_trace.json");
+        last_export_message_ = export_chrome_trace(path)
+            ? "Saved to " + path.string()
+            : "Could not write " + path.string();
+    }
+
+    if (!last_export_message_.empty()) {
+        ImGui::TextWrapped("%s", last_export_message_.c_str());
+    }
+
+    ImGui::End();
+}
+
+bool Profiler::export_chrome_trace(const std::filesystem::path& path)
+{
+    std::ofstream ofs(path, std::ios::trunc);
+    if (!ofs) {
+        spdlog::error("Could not open trace file {}", path.string());
+        return false;
+    }
+
+    // Phase names are literals from our own code, they need no escaping
+    ofs << R"({"displayTimeUnit":"ms","traceEvents":[)";
+    bool first = true;
+    for (const auto& event : events_) {
+        if (!first) {
+            ofs << ',';
+        }
+        first = false;
+
+        ofs << R"({"name":")" << event.name
+            << R"(","ph":"X","pid":1,"tid":1,"ts":)" << event.start_us
+            << R"(,"dur":)" << event.duration_us << '}';
+    }
+    ofs << "]}";
+    ofs.close();
+
+    if (!ofs) {
+        spdlog::error("Could not write trace file {}", path.string());
+        return false;
+    }
+
+    spdlog::info("Exported {} profiler events to {}", events_.size(),
+        path.string());
+    return true;
+}
+
+}
@@ -0,0 +1,103 @@
+#include "reachability.h"
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <restinio/asio_include.hpp>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+namespace vector_audio {
+
+namespace {
+    namespace asio = restinio::asio_ns;
+
+    // Shared with the thread doing the check, which may outlive the caller
+    struct Check {
+        std::mutex m;
+        std::condition_variable cv;
+        bool done = false;
+        bool reached = false;
+        bool stopped = false;
+    };
+
+    bool connectWithin(const std::string& name, const std::string& port,
+        std::chrono::milliseconds timeout)
+    {
+        asio::io_context context;
+        asio::ip::tcp::resolver resolver(context);
+        asio::ip::tcp::socket socket(context);
+        asio::steady_timer timer(context);
+
+        asio::error_code ec;
+        auto endpoints = resolver.resolve(name, port, ec);
+        if (ec) {
+            return false;
+        }
+
+        bool reached = false;
+        timer.expires_after(timeout);
+        timer.async_wait([&socket](const asio::error_code& error) {
+            if (!error) {
+                asio::error_code ignored;
+                socket.close(ignored);
+            }
+        });
+        asio::async_connect(socket, endpoints,
+            [&reached, &timer](const asio::error_code& error,
+                const asio::ip::tcp::endpoint& /*endpoint*/) {
+                reached = !error;
+                timer.cancel();
+            });
+
+        context.run();
+        return reached;
+    }
+}
+
+bool waitUntilReachable(const std::string& host,
+    std::chrono::milliseconds timeout, const StopToken& token)
+{
+    std::string_view rest = host;
+    std::string port = "80";
+    if (rest.substr(0, 8) == "https://") {
+        rest.remove_prefix(8);
+        port = "443";
+    } else if (rest.substr(0, 7) == "http://") {
+        rest.remove_prefix(7);
+    }
+
+    // IPv6 literals are bracketed, their colons are not a port
+    auto colon = rest.rfind(':');
+    auto bracket = rest.rfind(']');
+    if (colon != std::string_view::npos
+        && (bracket == std::string_view::npos || colon > bracket)) {
+        port = std::string(rest.substr(colon + 1));
+        rest = rest.substr(0, colon);
+    }
+    if (rest.size() >= 2 && rest.front() == '[' && rest.back() == ']') {
+        rest = rest.substr(1, rest.size() - 2);
+    }
+
+    auto check = std::make_shared<Check>();
+    std::thread([check, name = std::string(rest), port, timeout] {
+        auto reached = connectWithin(name, port, timeout);
+
+        const std::lock_guard<std::mutex> lk(check->m);
+        check->done = true;
+        check->reached = reached;
+        check->cv.notify_all();
+    }).detach();
+
+    StopCallback cancel(token, [&check] {
+        const std::lock_guard<std::mutex> lk(check->m);
+        check->stopped = true;
+        check->cv.notify_all();
+    });
+
+    std::unique_lock<std::mutex> lk(check->m);
+    check->cv.wait(lk, [&check] { return check->done || check->stopped; });
+    return check->reached && !check->stopped;
+}
+
+}
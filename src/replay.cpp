@@ -0,0 +1,391 @@
+#include "replay.h"
+#include "app_core.h"
+#include "binary_codec.h"
+#include "shared.h"
+#include <algorithm>
+#include <spdlog/fmt/chrono.h>
+#include <spdlog/spdlog.h>
+
+namespace vector_audio::replay {
+
+using codec::getString;
+using codec::getVarint;
+using codec::putString;
+using codec::putVarint;
+
+namespace {
+    constexpr std::string_view kMagic = "VAREPLAY";
+    constexpr char kVersion = 1;
+
+    // Only the events App reads data from carry a payload, the layout follows
+    // the pointer types documented in afv-native/event.h
+    std::string encodeEventPayload(
+        afv_native::ClientEventType evt, void* data, void* data2)
+    {
+        using afv_native::ClientEventType;
+        std::string payload;
+
+        switch (evt) {
+        case ClientEventType::VccsReceived:
+            if (data2 != nullptr) {
+                const auto& stations
+                    = *reinterpret_cast<std::map<std::string, unsigned int>*>(
+                        data2);
+                putVarint(payload, stations.size());
+                for (const auto& [callsign, frequency] : stations) {
+                    putString(payload, callsign);
+                    putVarint(payload, frequency);
+                }
+            }
+            break;
+        case ClientEventType::StationTransceiversUpdated:
+            if (data != nullptr) {
+                putString(payload, *reinterpret_cast<std::string*>(data));
+            }
+            break;
+        case ClientEventType::APIServerError:
+            if (data != nullptr) {
+                putVarint(payload,
+                    static_cast<std::uint64_t>(
+                        *reinterpret_cast<afv_native::afv::APISessionError*>(
+                            data)));
+            }
+            break;
+        case ClientEventType::VoiceServerError:
+        case ClientEventType::VoiceServerChannelError:
+            if (data != nullptr) {
+                putVarint(payload,
+                    static_cast<std::uint32_t>(*reinterpret_cast<int*>(data)));
+            }
+            break;
+        case ClientEventType::RxOpen:
+        case ClientEventType::RxClosed:
+            if (data != nullptr) {
+                putVarint(payload, *reinterpret_cast<unsigned int*>(data));
+            }
+            break;
+        case ClientEventType::StationDataReceived:
+            if (data != nullptr && data2 != nullptr) {
+                putVarint(payload, *reinterpret_cast<bool*>(data) ? 1 : 0);
+                const auto& station = *reinterpret_cast<
+                    std::pair<std::string, unsigned int>*>(data2);
+                putString(payload, station.first);
+                putVarint(payload, station.second);
+            }
+            break;
+        default:
+            break;
+        }
+
+        return payload;
+    }
+}
+
+bool Recorder::start(const std::filesystem::path& path)
+{
+    const std::lock_guard<std::mutex> lock(m_);
+    out_.open(path, std::ios::binary | std::ios::trunc);
+    if (!out_) {
+        spdlog::error("Could not open replay log {}", path.string());
+        return false;
+    }
+
+    out_.write(kMagic.data(), static_cast<std::streamsize>(kMagic.size()));
+    out_.put(kVersion);
+
+    start_ = std::chrono::steady_clock::now();
+    last_timestamp_ = std::chrono::microseconds(0);
+    recording_ = true;
+
+    spdlog::info("Recording replay log to {}", path.string());
+    return true;
+}
+
+void Recorder::stop()
+{
+    const std::lock_guard<std::mutex> lock(m_);
+    if (!recording_) {
+        return;
+    }
+
+    recording_ = false;
+    out_.close();
+}
+
+void Recorder::record_client_event(
+    afv_native::ClientEventType evt, void* data, void* data2)
+{
+    if (!recording_) {
+        return;
+    }
+
+    write(RecordKind::ClientEvent, static_cast<std::uint32_t>(evt), {},
+        encodeEventPayload(evt, data, data2));
+}
+
+void Recorder::record_http_response(
+    const std::string& url, int status, const std::string& body)
+{
+    if (!recording_) {
+        return;
+    }
+
+    write(RecordKind::HttpResponse, static_cast<std::uint32_t>(status), url,
+        body);
+}
+
+void Recorder::record_ptt(bool open)
+{
+    if (!recording_) {
+        return;
+    }
+
+    write(RecordKind::PttChange, open ? 1 : 0, {}, {});
+}
+
+void Recorder::write(RecordKind kind, std::uint32_t code,
+    std::string_view detail, std::string_view payload)
+{
+    auto timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start_);
+
+    std::string header;
+    header.push_back(static_cast<char>(kind));
+
+    const std::lock_guard<std::mutex> lock(m_);
+    if (!recording_) {
+        return;
+    }
+
+    // Records from different threads can race to the lock, the log must
+    // still move forward in time
+    timestamp = std::max(timestamp, last_timestamp_);
+    putVarint(header, (timestamp - last_timestamp_).count());
+    last_timestamp_ = timestamp;
+
+    putVarint(header, code);
+    putVarint(header, detail.size());
+    out_.write(header.data(), static_cast<std::streamsize>(header.size()));
+    out_.write(detail.data(), static_cast<std::streamsize>(detail.size()));
+
+    header.clear();
+    putVarint(header, payload.size());
+    out_.write(header.data(), static_cast<std::streamsize>(header.size()));
+    out_.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+}
+
+LogReader::LogReader(const std::filesystem::path& path)
+    : in_(path, std::ios::binary)
+{
+    std::string magic(kMagic.size(), '\0');
+    in_.read(magic.data(), static_cast<std::streamsize>(magic.size()));
+    valid_ = in_ && magic == kMagic && in_.get() == kVersion;
+
+    if (!valid_) {
+        spdlog::error("{} is not a replay log", path.string());
+    }
+}
+
+bool LogReader::read_varint(std::uint64_t& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        auto byte = in_.get();
+        if (byte == std::char_traits<char>::eof()) {
+            return false;
+        }
+
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool LogReader::read_string(std::string& value)
+{
+    // Larger than any datafile, a size past this means the log is corrupt
+    constexpr std::uint64_t kMaxStringSize = 64 * 1024 * 1024;
+
+    std::uint64_t size = 0;
+    if (!read_varint(size) || size > kMaxStringSize) {
+        return false;
+    }
+
+    value.resize(size);
+    in_.read(value.data(), static_cast<std::streamsize>(size));
+    return static_cast<std::uint64_t>(in_.gcount()) == size;
+}
+
+bool LogReader::next(Record& record)
+{
+    if (!valid_) {
+        return false;
+    }
+
+    auto kind = in_.get();
+    if (kind == std::char_traits<char>::eof()) {
+        return false;
+    }
+
+    std::uint64_t delta = 0;
+    std::uint64_t code = 0;
+    if (!read_varint(delta) || !read_varint(code)
+        || !read_string(record.detail) || !read_string(record.payload)) {
+        spdlog::warn("Replay log is truncated, stopping there");
+        valid_ = false;
+        return false;
+    }
+
+    timestamp_ += std::chrono::microseconds(delta);
+    record.kind = static_cast<RecordKind>(kind);
+    record.timestamp = timestamp_;
+    record.code = static_cast<std::uint32_t>(code);
+    return true;
+}
+
+bool ReplayEvent::decode(const Record& record)
+{
+    using afv_native::ClientEventType;
+
+    type_ = static_cast<ClientEventType>(record.code);
+    data_ = nullptr;
+    data2_ = nullptr;
+
+    std::string_view in = record.payload;
+    std::uint64_t value = 0;
+
+    switch (type_) {
+    case ClientEventType::VccsReceived: {
+        if (!getVarint(in, value)) {
+            return false;
+        }
+
+        stations_.clear();
+        for (std::uint64_t i = 0; i < value; i++) {
+            std::string callsign;
+            std::uint64_t frequency = 0;
+            if (!getString(in, callsign) || !getVarint(in, frequency)) {
+                return false;
+            }
+            stations_.emplace(
+                std::move(callsign), static_cast<unsigned int>(frequency));
+        }
+
+        // App only checks that the station name is set
+        data_ = &string_;
+        data2_ = &stations_;
+        return true;
+    }
+    case ClientEventType::StationTransceiversUpdated:
+        if (!getString(in, string_)) {
+            return false;
+        }
+        data_ = &string_;
+        return true;
+    case ClientEventType::APIServerError:
+        if (!getVarint(in, value)) {
+            return false;
+        }
+        api_error_ = static_cast<afv_native::afv::APISessionError>(value);
+        data_ = &api_error_;
+        return true;
+    case ClientEventType::VoiceServerError:
+    case ClientEventType::VoiceServerChannelError:
+        if (!getVarint(in, value)) {
+            return false;
+        }
+        int_ = static_cast<int>(static_cast<std::uint32_t>(value));
+        data_ = &int_;
+        return true;
+    case ClientEventType::RxOpen:
+    case ClientEventType::RxClosed:
+        if (!getVarint(in, value)) {
+            return false;
+        }
+        unsigned_ = static_cast<unsigned int>(value);
+        data_ = &unsigned_;
+        return true;
+    case ClientEventType::StationDataReceived: {
+        std::uint64_t frequency = 0;
+        if (!getVarint(in, value) || !getString(in, station_.first)
+            || !getVarint(in, frequency)) {
+            return false;
+        }
+        flag_ = value != 0;
+        station_.second = static_cast<unsigned int>(frequency);
+        data_ = &flag_;
+        data2_ = &station_;
+        return true;
+    }
+    default:
+        return true;
+    }
+}
+
+ReplayDriver::ReplayDriver(
+    const std::filesystem::path& path, application::AppCore& core)
+    : reader_(path)
+    , core_(core)
+{
+}
+
+bool ReplayDriver::advance(std::chrono::microseconds step)
+{
+    if (done_) {
+        return false;
+    }
+
+    now_ += step;
+    while (true) {
+        if (!pending_) {
+            Record record;
+            if (!reader_.next(record)) {
+                done_ = true;
+                spdlog::info("Replay finished at {}",
+                    std::chrono::duration_cast<std::chrono::milliseconds>(
+                        now_));
+                return false;
+            }
+            pending_ = std::move(record);
+        }
+
+        if (pending_->timestamp > now_) {
+            return true;
+        }
+
+        dispatch(*pending_);
+        pending_.reset();
+    }
+}
+
+void ReplayDriver::dispatch(const Record& record)
+{
+    switch (record.kind) {
+    case RecordKind::ClientEvent: {
+        ReplayEvent event;
+        if (!event.decode(record)) {
+            spdlog::warn("Skipping a malformed replayed client event");
+            return;
+        }
+        core_.eventCallback(event.type(), event.data(), event.data2());
+        break;
+    }
+    case RecordKind::HttpResponse:
+        core_.dataHandler()->replayResponse(
+            record.detail, static_cast<int>(record.code), record.payload);
+        break;
+    case RecordKind::PttChange:
+        shared::isPttOpen = record.code != 0;
+        if (core_.client() != nullptr) {
+            core_.client()->SetPtt(shared::isPttOpen);
+        }
+        break;
+    default:
+        spdlog::warn("Skipping an unknown replay record");
+        break;
+    }
+}
+
+}
@@ -0,0 +1,246 @@
+#include "sdk_socket_server.h"
+#include <cctype>
+#include <charconv>
+#include <exception>
+#include <spdlog/spdlog.h>
+#include <system_error>
+
+namespace vector_audio {
+
+#ifdef VECTOR_HAS_SDK_SOCKET
+
+namespace {
+    // Way more than any SDK request, a client sending more is not one
+    constexpr std::size_t kMaxRequestSize = 8192;
+
+    std::string_view headerValue(std::string_view head, std::string_view name)
+    {
+        std::size_t pos = 0;
+        while ((pos = head.find("\r\n", pos)) != std::string_view::npos) {
+            pos += 2;
+            auto end = head.find("\r\n", pos);
+            auto line = head.substr(pos, end - pos);
+            auto colon = line.find(':');
+            if (colon == std::string_view::npos || colon != name.size()) {
+                continue;
+            }
+
+            bool same = true;
+            for (std::size_t i = 0; i < colon; i++) {
+                if (std::tolower(static_cast<unsigned char>(line[i]))
+                    != std::tolower(static_cast<unsigned char>(name[i]))) {
+                    same = false;
+                    break;
+                }
+            }
+            if (!same) {
+                continue;
+            }
+
+            auto value = line.substr(colon + 1);
+            while (!value.empty() && value.front() == ' ') {
+                value.remove_prefix(1);
+            }
+            return value;
+        }
+
+        return {};
+    }
+}
+
+SDKSocketServer::SDKSocketServer(
+    EventLoop& loop, std::filesystem::path path, Handler handler)
+    : strand_(restinio::asio_ns::make_strand(loop.context()))
+    , acceptor_(strand_)
+    , path_(std::move(path))
+    , handler_(std::move(handler))
+{
+    std::error_code ec;
+
+    // A socket left behind by a crash would make bind fail, anything else at
+    // that path is not ours to delete
+    if (std::filesystem::is_socket(path_, ec)) {
+        std::filesystem::remove(path_, ec);
+    }
+
+    try {
+        restinio::asio_ns::local::stream_protocol::endpoint endpoint(
+            path_.string());
+        acceptor_.open(endpoint.protocol());
+        acceptor_.bind(endpoint);
+
+        // Nobody can connect before listen(), so there is no window where the
+        // socket is open to everyone
+        std::filesystem::permissions(path_,
+            std::filesystem::perms::owner_read
+                | std::filesystem::perms::owner_write,
+            std::filesystem::perm_options::replace);
+
+        acceptor_.listen();
+    } catch (std::exception& ex) {
+        spdlog::error("Failed to create the SDK socket {}: {}", path_.string(),
+            ex.what());
+        return;
+    }
+
+    listening_ = true;
+    spawn(accept());
+    spdlog::info("SDK listening on {}", path_.string());
+}
+
+SDKSocketServer::~SDKSocketServer()
+{
+    // Closing the acceptor and the connections ends their coroutines
+    restinio::asio_ns::post(strand_, [this] {
+        try {
+            acceptor_.close();
+            for (const auto& socket : connections_) {
+                socket->close();
+            }
+        } catch (std::exception& ex) {
+            spdlog::warn("Error closing the SDK socket: {}", ex.what());
+        }
+    });
+
+    {
+        std::unique_lock<std::mutex> lk(tasks_m_);
+        tasks_cv_.wait(lk, [this] { return tasks_ == 0; });
+    }
+
+    if (listening_) {
+        std::error_code ec;
+        std::filesystem::remove(path_, ec);
+    }
+}
+
+void SDKSocketServer::spawn(restinio::asio_ns::awaitable<void> task)
+{
+    {
+        const std::lock_guard<std::mutex> l(tasks_m_);
+        tasks_++;
+    }
+
+    restinio::asio_ns::co_spawn(
+        strand_, std::move(task), [this](const std::exception_ptr& ex) {
+            if (ex) {
+                try {
+                    std::rethrow_exception(ex);
+                } catch (std::exception& e) {
+                    spdlog::debug("SDK socket task failed: {}", e.what());
+                }
+            }
+
+            // Notified under the lock, the destructor may return right after
+            const std::lock_guard<std::mutex> l(tasks_m_);
+            tasks_--;
+            tasks_cv_.notify_all();
+        });
+}
+
+restinio::asio_ns::awaitable<void> SDKSocketServer::accept()
+{
+    while (acceptor_.is_open()) {
+        auto socket = std::make_shared<Socket>(strand_);
+        try {
+            co_await acceptor_.async_accept(
+                *socket, restinio::asio_ns::use_awaitable);
+        } catch (std::exception& ex) {
+            // Closing the acceptor on shutdown ends up here as well
+            if (acceptor_.is_open()) {
+                spdlog::error("SDK socket stopped accepting: {}", ex.what());
+            }
+            break;
+        }
+
+        connections_.insert(socket);
+        spawn(serve(socket));
+    }
+}
+
+restinio::asio_ns::awaitable<void> SDKSocketServer::serve(
+    std::shared_ptr<Socket> socket)
+{
+    std::string buffer;
+    bool keep_alive = true;
+
+    try {
+        while (keep_alive) {
+            auto head_size = co_await restinio::asio_ns::async_read_until(
+                *socket,
+                restinio::asio_ns::dynamic_buffer(buffer, kMaxRequestSize),
+                "\r\n\r\n", restinio::asio_ns::use_awaitable);
+            std::string_view head(buffer.data(), head_size);
+
+            // GET /target HTTP/1.1
+            auto method_end = head.find(' ');
+            auto target_end = head.find(' ', method_end + 1);
+            if (method_end == std::string_view::npos
+                || target_end == std::string_view::npos) {
+                break;
+            }
+            auto method = head.substr(0, method_end);
+            auto target
+                = head.substr(method_end + 1, target_end - method_end - 1);
+            auto version = head.substr(target_end + 1, 8);
+
+            auto connection = headerValue(head, "Connection");
+            keep_alive = version == "HTTP/1.1" ? connection != "close"
+                                               : connection == "keep-alive";
+
+            // The SDK routes take no body, but one that is sent is skipped so
+            // the next request on the connection starts where it should
+            std::size_t body_size = 0;
+            auto length = headerValue(head, "Content-Length");
+            std::from_chars(
+                length.data(), length.data() + length.size(), body_size);
+            if (head_size + body_size > kMaxRequestSize) {
+                break;
+            }
+
+            auto body = handler_(method == "GET", target);
+            auto response = fmt::format("HTTP/1.1 200 OK\r\n"
+                                        "Content-Type: text/plain\r\n"
+                                        "Content-Length: {}\r\n"
+                                        "Connection: {}\r\n\r\n{}",
+                body.size(), keep_alive ? "keep-alive" : "close", body);
+
+            if (buffer.size() < head_size + body_size) {
+                co_await restinio::asio_ns::async_read(*socket,
+                    restinio::asio_ns::dynamic_buffer(buffer, kMaxRequestSize),
+                    restinio::asio_ns::transfer_exactly(
+                        head_size + body_size - buffer.size()),
+                    restinio::asio_ns::use_awaitable);
+            }
+            buffer.erase(0, head_size + body_size);
+
+            co_await restinio::asio_ns::async_write(*socket,
+                restinio::asio_ns::buffer(response),
+                restinio::asio_ns::use_awaitable);
+        }
+    } catch (std::exception&) {
+        // The client went away, or the server is closing
+    }
+
+    connections_.erase(socket);
+    try {
+        socket->close();
+    } catch (std::exception&) {
+    }
+}
+
+#else
+
+SDKSocketServer::SDKSocketServer(
+    EventLoop& /*loop*/, std::filesystem::path path, Handler handler)
+    : path_(std::move(path))
+    , handler_(std::move(handler))
+{
+    spdlog::warn("The SDK socket {} is not supported on this platform",
+        path_.string());
+}
+
+SDKSocketServer::~SDKSocketServer() = default;
+
+#endif
+
+}
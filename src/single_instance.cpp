@@ -23,12 +23,17 @@ namespace vector_audio {
 #endif
   };
 
-  SingleInstance::SingleInstance() : instance_(new instance) {
+  SingleInstance::SingleInstance(const std::string& instance_name) : instance_(new instance) {
+    std::string key = INSTANCE_KEY;
+    if (!instance_name.empty()) {
+      key += "." + instance_name;
+    }
+
 #if defined(_WIN32)
-    instance_->mutex = CreateMutexA(NULL, FALSE, INSTANCE_KEY.c_str());
+    instance_->mutex = CreateMutexA(NULL, FALSE, key.c_str());
     instance_->exists = GetLastError() == ERROR_ALREADY_EXISTS;
 #elif defined(__APPLE__) || defined(__linux__)
-    instance_->blockingFile = open(("/tmp/" + INSTANCE_KEY).c_str(), O_CREAT | O_RDWR, 0666);
+    instance_->blockingFile = open(("/tmp/" + key).c_str(), O_CREAT | O_RDWR, 0666);
     struct flock lock {};
     lock.l_type = F_WRLCK;
     lock.l_whence = SEEK_CUR;
@@ -0,0 +1,69 @@
+#include "startup.h"
+#include <spdlog/fmt/chrono.h>
+#include <spdlog/spdlog.h>
+
+namespace vector_audio {
+
+Startup::Startup()
+    : start_(std::chrono::steady_clock::now())
+{
+}
+
+void Startup::run(const std::string& name, const std::function<void()>& phase)
+{
+    auto phase_start = std::chrono::steady_clock::now();
+    phase();
+    record(name, phase_start);
+}
+
+void Startup::start(const std::string& name, std::function<void()> phase)
+{
+    pending_[name] = std::async(std::launch::async,
+        [this, name, phase = std::move(phase)]() {
+            auto phase_start = std::chrono::steady_clock::now();
+            phase();
+            record(name, phase_start);
+        });
+}
+
+void Startup::wait(const std::string& name)
+{
+    auto it = pending_.find(name);
+    if (it == pending_.end()) {
+        return;
+    }
+
+    auto wait_start = std::chrono::steady_clock::now();
+    auto phase = std::move(it->second);
+    pending_.erase(it);
+    phase.get();
+
+    spdlog::debug("Waited {} for startup phase {}",
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - wait_start),
+        name);
+}
+
+void Startup::log_summary(const std::string& milestone)
+{
+    const std::lock_guard<std::mutex> l(m_);
+    for (const auto& [name, duration] : timings_) {
+        spdlog::info("Startup phase {} took {}", name, duration);
+    }
+
+    spdlog::info("{} after {}", milestone,
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start_));
+}
+
+void Startup::record(
+    const std::string& name, std::chrono::steady_clock::time_point phase_start)
+{
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - phase_start);
+
+    const std::lock_guard<std::mutex> l(m_);
+    timings_.emplace_back(name, duration);
+}
+
+}
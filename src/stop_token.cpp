@@ -0,0 +1,73 @@
+#include "stop_token.h"
+#include <utility>
+
+namespace vector_audio {
+
+StopToken::StopToken(std::shared_ptr<detail::StopState> state)
+    : state_(std::move(state))
+{
+}
+
+StopSource::StopSource()
+    : state_(std::make_shared<detail::StopState>())
+{
+}
+
+StopToken StopSource::get_token() const { return StopToken(state_); }
+
+void StopSource::request_stop()
+{
+    std::unique_lock<std::mutex> lk(state_->m);
+    if (state_->stopped) {
+        return;
+    }
+    state_->stopped = true;
+
+    // The lock is released while a callback runs, so it can take as long as
+    // it needs and callbacks can still be removed meanwhile
+    while (!state_->callbacks.empty()) {
+        auto it = state_->callbacks.begin();
+        auto callback = std::move(it->second);
+        state_->running = it->first;
+        state_->callbacks.erase(it);
+
+        lk.unlock();
+        callback();
+        lk.lock();
+
+        state_->running = -1;
+        state_->cv.notify_all();
+    }
+}
+
+StopCallback::StopCallback(
+    const StopToken& token, std::function<void()> callback)
+    : state_(token.state_)
+{
+    if (!state_) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lk(state_->m);
+    if (state_->stopped) {
+        lk.unlock();
+        callback();
+        return;
+    }
+
+    id_ = state_->next_id++;
+    state_->callbacks.emplace(id_, std::move(callback));
+}
+
+StopCallback::~StopCallback()
+{
+    if (!state_ || id_ < 0) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lk(state_->m);
+    state_->callbacks.erase(id_);
+    state_->cv.wait(lk, [this] { return state_->running != id_; });
+}
+
+}
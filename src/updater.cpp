@@ -1,15 +1,86 @@
 #include "updater.h"
+#include "config.h"
+#include "reachability.h"
 
 namespace vector_audio {
 
-// This class is blocking on purpose, we want to update if needed before
-// anything
-updater::updater()
-    : mNeedUpdate(false)
-    , cli(mBaseUrl)
+// The version check runs in the background so that a slow or unreachable
+// endpoint never holds up startup. Until it answers, we use the last version we
+// saw.
+updater::updater(const std::string& base_url)
+    : mCheck(std::make_shared<Check>(base_url))
 {
+    mCheck->cli.set_connection_timeout(5);
+    mCheck->cli.set_read_timeout(5);
+
+    try {
+        const auto& last_version = shared::lastSeenVersion;
+        if (!last_version.empty()
+            && semver::version { std::string(VECTOR_VERSION) }
+                < semver::version { last_version }) {
+            mCheck->new_version = semver::version { last_version };
+            mCheck->need_update = true;
+        }
+    } catch (std::exception& ex) {
+        spdlog::warn("Ignoring cached updater version: {}", ex.what());
+    }
+
+    mCheckThread = std::thread([check = mCheck] {
+        check_version(*check);
+
+        const std::lock_guard<std::mutex> lk(check->m);
+        check->finished = true;
+        check->cv.notify_all();
+    });
+}
+
+updater::~updater()
+{
+    // Closing the app should not wait for a slow version check. Stopping the
+    // client waits for a connect in progress, so even the stop runs apart.
+    auto check = mCheck;
+    std::thread stopper([check] { check->stop.request_stop(); });
+
+    bool finished = false;
+    {
+        std::unique_lock<std::mutex> lk(check->m);
+        finished = check->cv.wait_for(
+            lk, kShutdownWait, [&check] { return check->finished; });
+    }
+
+    if (finished) {
+        stopper.join();
+        mCheckThread.join();
+        return;
+    }
+
+    spdlog::warn("Version check did not stop in time, leaving it behind");
+    stopper.detach();
+    mCheckThread.detach();
+}
+
+void updater::check_version(Check& check)
+{
+    // httplib's connect cannot be aborted, so the host is checked first
+    if (!waitUntilReachable(
+            check.base_url, std::chrono::seconds(5), check.stop.get_token())) {
+        if (!check.stop.stop_requested()) {
+            spdlog::critical("Cannot access updater endpoint, please update manually!");
+        }
+        return;
+    }
+
+    StopCallback cancel(check.stop.get_token(), [&check] { check.cli.stop(); });
+    if (check.stop.stop_requested()) {
+        return;
+    }
+
     // Check version file
-    auto res = cli.Get(mVersionUrl);
+    auto res = check.cli.Get(kVersionUrl);
+    if (check.stop.stop_requested()) {
+        return;
+    }
+
     if (!res) {
         spdlog::critical("Cannot access updater endpoint, please update manually!");
         return;
@@ -17,18 +88,24 @@ updater::updater()
 
     if (res->status == 200) {
         semver::version current_version;
+        semver::version new_version;
 
         try {
             current_version = semver::version { std::string(VECTOR_VERSION) };
-            mNewVersion = semver::version { res->body };
+            new_version = semver::version { res->body };
         } catch (std::invalid_argument& ex) {
             spdlog::critical("Cannot parse updater version, please update manually!");
             return;
         }
 
-        if (current_version < mNewVersion) {
-            mNeedUpdate = true;
+        if (current_version < new_version) {
+            const std::lock_guard<std::mutex> lock(check.version_lock);
+            check.new_version = new_version;
+            check.need_update = true;
+        } else {
+            check.need_update = false;
         }
+        check.done = true;
     } else {
         spdlog::critical(
             "Updater endpoint did not return ok, please update manually!");
@@ -38,7 +115,7 @@ updater::updater()
 bool updater::need_update()
 {
 #ifdef NDEBUG
-    return mNeedUpdate;
+    return mCheck->need_update;
 #else
     return false;
 #endif
@@ -46,22 +123,47 @@ bool updater::need_update()
 
 void updater::draw()
 {
-    ImGui::Begin("VectorAudio Updater", NULL,
-        ImGuiWindowFlags_NoNav | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoScrollWithMouse | ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoResize);
+    // The config is only ever touched from the UI thread, so we cache the
+    // result here rather than in the checker thread
+    std::string new_version;
+    {
+        const std::lock_guard<std::mutex> lock(mCheck->version_lock);
+        new_version = mCheck->new_version.to_string();
+    }
+
+    if (mCheck->done && !mResultCached) {
+        mResultCached = true;
+        shared::lastSeenVersion
+            = mCheck->need_update ? new_version : std::string(VECTOR_VERSION);
+        // Settings may be open with edits the user has not saved yet
+        Configuration::save_setting("updater", "last_version");
+    }
+
+    if (!need_update() || mDismissed) {
+        return;
+    }
+
+    const auto& display_size = ImGui::GetIO().DisplaySize;
+    ImGui::SetNextWindowPos(
+        ImVec2(0.0F, display_size.y), ImGuiCond_Always, ImVec2(0.0F, 1.0F));
+    ImGui::SetNextWindowSize(ImVec2(display_size.x, 0.0F));
+    ImGui::Begin("VectorAudio Updater", nullptr,
+        ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoNav | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing);
 
     ImGui::Text(
         "A new version of VectorAudio is available, please update it! (%s -> "
         "%s)",
-        VECTOR_VERSION, mNewVersion.to_string().c_str());
-
-    ImGui::NewLine();
-    ImGui::Separator();
+        VECTOR_VERSION, new_version.c_str());
 
     if (ImGui::Button("Download from GitHub")) {
         util::PlatformOpen(mArtefactFileUrl);
     }
+    ImGui::SameLine();
+    if (ImGui::Button("Dismiss")) {
+        mDismissed = true;
+    }
 
     ImGui::End();
 }
 
-} // namespace vector_audio
\ No newline at end of file
+} // namespace vector_audio
@@ -0,0 +1,190 @@
+#include "vatsim_parsers.h"
+#include "util.h"
+#include <charconv>
+#include <exception>
+#include <spdlog/spdlog.h>
+
+namespace {
+// Digits only, in the range a TCP port can take
+bool isValidPort(std::string_view port)
+{
+    unsigned int value = 0;
+    auto [end, ec]
+        = std::from_chars(port.data(), port.data() + port.size(), value);
+    return ec == std::errc() && end == port.data() + port.size() && value >= 1
+        && value <= 65535;
+}
+}
+
+namespace vector_audio::vatsim::parsers {
+
+// Splits a slurper CSV line in place, the fields are views into the line.
+// Lines that do not have all the fields we read are rejected.
+bool splitSlurperLine(std::string_view line, SlurperLine& out)
+{
+    util::StringTokenizer fields(line, ',');
+    std::string_view field;
+    size_t index = 0;
+
+    while (fields.next(field)) {
+        switch (index) {
+        case 1:
+            out.callsign = field;
+            break;
+        case 2:
+            out.type = field;
+            break;
+        case 3:
+            out.frequency = field;
+            break;
+        case 5:
+            out.latitude = field;
+            break;
+        case 6:
+            out.longitude = field;
+            break;
+        default:
+            break;
+        }
+        index++;
+    }
+
+    return index >= 7;
+}
+
+std::vector<std::string> parseStatusFile(const std::string& data)
+{
+    try {
+        if (!nlohmann::json::accept(data)) {
+            return {};
+        }
+
+        auto status_json = nlohmann::json::parse(data);
+        return status_json["data"]["v3"].get<std::vector<std::string>>();
+    } catch (std::exception& e) {
+        spdlog::error("Status file check failed: {}", e.what());
+    }
+
+    return {};
+}
+
+// Splits a URL into the host part that httplib::Client expects (scheme, host
+// and optional port) and the path with its query string. User info and
+// fragments are dropped.
+bool splitDatafileUrl(
+    const std::string& url, std::string& host, std::string& path)
+{
+    std::string_view rest(url);
+
+    std::string_view scheme;
+    auto scheme_end = rest.find("://");
+    if (scheme_end != std::string_view::npos) {
+        scheme = rest.substr(0, scheme_end);
+        if (scheme != "http" && scheme != "https") {
+            return false;
+        }
+        rest.remove_prefix(scheme_end + 3);
+    }
+
+    auto authority_end = rest.find_first_of("/?#");
+    auto authority = rest.substr(0, authority_end);
+    rest.remove_prefix(authority.size());
+
+    auto user_info_end = authority.rfind('@');
+    if (user_info_end != std::string_view::npos) {
+        authority.remove_prefix(user_info_end + 1);
+    }
+
+    // An IPv6 literal has to be closed, and only a port may follow it. Other
+    // hosts take the port after their last colon.
+    std::string_view port;
+    bool has_port = false;
+    if (!authority.empty() && authority.front() == '[') {
+        auto ipv6_end = authority.find(']');
+        if (ipv6_end == std::string_view::npos) {
+            return false;
+        }
+
+        auto after = authority.substr(ipv6_end + 1);
+        if (!after.empty()) {
+            if (after.front() != ':') {
+                return false;
+            }
+            port = after.substr(1);
+            has_port = true;
+        }
+    } else if (authority.find_first_of("[]") != std::string_view::npos) {
+        return false;
+    } else if (auto port_start = authority.rfind(':');
+               port_start != std::string_view::npos) {
+        port = authority.substr(port_start + 1);
+        has_port = true;
+    }
+
+    if (has_port && !isValidPort(port)) {
+        return false;
+    }
+
+    if (authority.empty() || authority.front() == ':') {
+        return false;
+    }
+
+    auto fragment_start = rest.find('#');
+    if (fragment_start != std::string_view::npos) {
+        rest = rest.substr(0, fragment_start);
+    }
+
+    host.clear();
+    if (!scheme.empty()) {
+        host.append(scheme);
+        host.append("://");
+    }
+    host.append(authority);
+
+    path.clear();
+    if (rest.empty() || rest.front() != '/') {
+        path.push_back('/');
+    }
+    path.append(rest);
+
+    return true;
+}
+
+bool parsePilotPositionFromSlurper(
+    std::string_view data, double& latitude, double& longitude)
+{
+    util::StringTokenizer lines(data, '\n');
+    std::string_view line;
+    SlurperLine res;
+
+    while (lines.next(line)) {
+        if (line.empty() || !splitSlurperLine(line, res)) {
+            continue;
+        }
+
+        if (res.type == "pilot") {
+            latitude = util::toDouble(res.latitude);
+            longitude = util::toDouble(res.longitude);
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool matchPilot(const nlohmann::json& pilot, const std::string& callsign,
+    double& latitude, double& longitude)
+{
+    auto pilot_callsign = pilot.find("callsign");
+    if (pilot_callsign == pilot.end() || *pilot_callsign != callsign) {
+        return false;
+    }
+
+    latitude = pilot.at("latitude").get<double>();
+    longitude = pilot.at("longitude").get<double>();
+
+    return true;
+}
+
+}
@@ -0,0 +1,20 @@
+#include "offline_handler.h"
+#include "shared.h"
+#include <benchmark/benchmark.h>
+#include <spdlog/spdlog.h>
+
+int main(int argc, char** argv)
+{
+    // Logging would be measured along with the code under test
+    spdlog::set_level(spdlog::level::off);
+    vector_audio::shared::vatsim_cid = vector_audio::testing::kFixtureCid;
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include "datafile_diff.h"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <utility>
+
+using vector_audio::vatsim::DatafileSnapshot;
+
+namespace {
+
+constexpr int kControllers = 300;
+
+// A network of the given size one poll apart: every pilot moved, and one in
+// fifty pilots and controllers came or went
+std::pair<DatafileSnapshot, DatafileSnapshot> consecutivePolls(int pilots)
+{
+    DatafileSnapshot before;
+    DatafileSnapshot after;
+
+    for (int i = 0; i < pilots; i++) {
+        nlohmann::json pilot { { "cid", 1000000 + i },
+            { "callsign", "PLT" + std::to_string(i) },
+            { "latitude", 40.0 + i * 0.001 }, { "longitude", -70.0 } };
+        if (i % 50 != 0) {
+            before.add("pilots", pilot);
+        }
+        pilot["latitude"] = pilot["latitude"].get<double>() + 0.01;
+        if (i % 50 != 1) {
+            after.add("pilots", pilot);
+        }
+    }
+
+    for (int i = 0; i < kControllers; i++) {
+        nlohmann::json controller { { "cid", 2000000 + i },
+            { "callsign", "CTL" + std::to_string(i) + "_CTR" },
+            { "frequency", "124.190" } };
+        if (i % 50 != 0) {
+            before.add("controllers", controller);
+        }
+        if (i % 50 == 2) {
+            controller["frequency"] = "199.998";
+        }
+        if (i % 50 != 1) {
+            after.add("controllers", controller);
+        }
+    }
+
+    return { std::move(before), std::move(after) };
+}
+
+// The diff every poll runs while the SDK follows changes. About 2500 pilots
+// is a busy evening on the network, 12000 a record event.
+void BM_DatafileDiff(benchmark::State& state)
+{
+    auto [before, after] = consecutivePolls(static_cast<int>(state.range(0)));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(after.diff(before));
+    }
+    state.SetItemsProcessed(
+        static_cast<std::int64_t>(state.iterations() * after.size()));
+}
+BENCHMARK(BM_DatafileDiff)->Arg(2500)->Arg(12000);
+
+}
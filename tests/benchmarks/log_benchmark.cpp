@@ -0,0 +1,79 @@
+#include "config.h"
+#include "shared.h"
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include <memory>
+#include <spdlog/async.h>
+#include <spdlog/sinks/basic_file_sink.h>
+#include <spdlog/spdlog.h>
+
+using namespace vector_audio;
+
+namespace {
+
+// The loggers as the app sets them up, over a scratch file rather than the
+// log in the config folder
+std::shared_ptr<spdlog::logger> afvLogger()
+{
+    static auto logger = [] {
+        spdlog::init_thread_pool(8192, 1);
+        auto path = std::filesystem::temp_directory_path()
+            / "vector_audio_log_benchmark.log";
+        auto sink
+            = std::make_shared<spdlog::sinks::basic_file_sink_mt>(
+                path.string(), true);
+        spdlog::set_default_logger(std::make_shared<spdlog::async_logger>(
+            "VectorAudio", sink, spdlog::thread_pool(),
+            spdlog::async_overflow_policy::block));
+
+        shared::logFlushInterval = 5;
+        shared::afvJsonLog = false;
+        Configuration::apply_log_settings();
+        return spdlog::get("afv_native");
+    }();
+    return logger;
+}
+
+// A debug level afv-native line, logged the way its logger callback does. The
+// caller waits once the 8192 entry queue is full, so over a long run this is
+// the rate the logging thread gets through as well as what a line costs the
+// thread that logs it. Arg 1 flushes every line as the logger used to.
+void BM_AfvLogLine(benchmark::State& state)
+{
+    auto logger = afvLogger();
+    shared::logLevel = "info";
+    shared::afvLogLevel = "debug";
+    Configuration::apply_log_levels();
+    logger->flush_on(
+        state.range(0) == 1 ? spdlog::level::info : spdlog::level::warn);
+
+    for (auto _ : state) {
+        logger->info("{} {}", "AudioDevice",
+            "Output callback took 312us, 0 underruns, 480 frames");
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    logger->flush_on(spdlog::level::warn);
+    spdlog::set_level(spdlog::level::off);
+}
+BENCHMARK(BM_AfvLogLine)->Arg(0)->Arg(1)->UseRealTime();
+
+// A line below the level, what afv-native costs once its level is raised
+void BM_AfvLogLineFiltered(benchmark::State& state)
+{
+    auto logger = afvLogger();
+    shared::logLevel = "info";
+    shared::afvLogLevel = "warning";
+    Configuration::apply_log_levels();
+
+    for (auto _ : state) {
+        logger->info("{} {}", "AudioDevice",
+            "Output callback took 312us, 0 underruns, 480 frames");
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    spdlog::set_level(spdlog::level::off);
+}
+BENCHMARK(BM_AfvLogLineFiltered);
+
+}
@@ -0,0 +1,133 @@
+#include "fixtures.h"
+#include "offline_handler.h"
+#include "vatsim_parsers.h"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <regex>
+#include <string>
+#include <vector>
+
+using namespace vector_audio::testing;
+namespace parsers = vector_audio::vatsim::parsers;
+
+namespace {
+
+void setBytes(benchmark::State& state, std::size_t size)
+{
+    state.SetBytesProcessed(
+        static_cast<std::int64_t>(state.iterations() * size));
+}
+
+// A whole session check, as the polling loop runs it on a slurper response
+void BM_ParseSlurper(benchmark::State& state)
+{
+    auto data = loadFixture("slurper_controller.txt");
+    auto url = slurperSessionUrl();
+    auto& handler = offlineHandler();
+
+    for (auto _ : state) {
+        handler.replayResponse(url, 200, data);
+        benchmark::ClobberMemory();
+    }
+    setBytes(state, data.size());
+}
+BENCHMARK(BM_ParseSlurper);
+
+void BM_ParsePilotPositionFromSlurper(benchmark::State& state)
+{
+    auto data = loadFixture("slurper_pilot.txt");
+    double latitude = 0.0;
+    double longitude = 0.0;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parsers::parsePilotPositionFromSlurper(
+            data, latitude, longitude));
+    }
+    setBytes(state, data.size());
+}
+BENCHMARK(BM_ParsePilotPositionFromSlurper);
+
+void BM_ParseStatusFile(benchmark::State& state)
+{
+    auto data = loadFixture("status.json");
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parsers::parseStatusFile(data));
+    }
+    setBytes(state, data.size());
+}
+BENCHMARK(BM_ParseStatusFile);
+
+void BM_SplitDatafileUrl(benchmark::State& state)
+{
+    auto urls = parsers::parseStatusFile(loadFixture("status.json"));
+    std::string host;
+    std::string path;
+
+    for (auto _ : state) {
+        for (const auto& url : urls) {
+            benchmark::DoNotOptimize(
+                parsers::splitDatafileUrl(url, host, path));
+        }
+    }
+    state.SetItemsProcessed(
+        static_cast<std::int64_t>(state.iterations() * urls.size()));
+}
+BENCHMARK(BM_SplitDatafileUrl);
+
+// The regex getLatestDatafileURL used before the splitter, it was built again
+// on every status refresh
+void BM_SplitDatafileUrlRegex(benchmark::State& state)
+{
+    auto urls = parsers::parseStatusFile(loadFixture("status.json"));
+    std::string host;
+    std::string path;
+
+    for (auto _ : state) {
+        for (const auto& url : urls) {
+            std::regex regex("^(https?:\\/\\/)?(?:[^@\n]+@)?(?:www\\.)?"
+                             "([^:\\/\n?]+)(\\/[.A-z0-9/-]+)$");
+            std::smatch m;
+            std::regex_match(url, m, regex);
+            if (m.size() == 4) {
+                host = m[1].str() + m[2].str();
+                path = m[3].str();
+            }
+            benchmark::DoNotOptimize(path);
+        }
+    }
+    state.SetItemsProcessed(
+        static_cast<std::int64_t>(state.iterations() * urls.size()));
+}
+BENCHMARK(BM_SplitDatafileUrlRegex);
+
+// Our controller entry sits after all the pilots, as in a real datafile
+void BM_ParseDatafile(benchmark::State& state)
+{
+    auto data = loadFixture("vatsim-data.json");
+    auto& handler = offlineHandler();
+
+    for (auto _ : state) {
+        handler.replayResponse(kDatafileUrl, 200, data);
+        benchmark::ClobberMemory();
+    }
+    setBytes(state, data.size());
+}
+BENCHMARK(BM_ParseDatafile);
+
+// The last pilot of the fixture, so the whole pilots array is read
+void BM_ParsePilotPositionFromDatafile(benchmark::State& state)
+{
+    auto data = loadFixture("vatsim-data.json");
+    double latitude = 0.0;
+    double longitude = 0.0;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            findPilotInDatafile(data, "DLH4AB", latitude, longitude));
+    }
+    setBytes(state, data.size());
+}
+BENCHMARK(BM_ParsePilotPositionFromDatafile);
+
+}
@@ -0,0 +1,86 @@
+#include "application.h"
+#include "imgui.h"
+#include "mock_afv_client.h"
+#include "shared.h"
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+
+using namespace vector_audio;
+
+namespace {
+
+// ImGui only needs a display size and a built font atlas to lay out a frame,
+// the draw lists are built but never handed to a renderer
+class HeadlessImGui {
+public:
+    HeadlessImGui()
+    {
+        ImGui::CreateContext();
+        ImGuiIO& io = ImGui::GetIO();
+        io.DisplaySize = ImVec2(800.0F, 600.0F);
+        io.DeltaTime = 1.0F / 30.0F;
+        io.IniFilename = nullptr;
+
+        unsigned char* pixels = nullptr;
+        int width = 0;
+        int height = 0;
+        io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+    }
+
+    ~HeadlessImGui() { ImGui::DestroyContext(); }
+
+    HeadlessImGui(const HeadlessImGui&) = delete;
+    HeadlessImGui& operator=(const HeadlessImGui&) = delete;
+};
+
+// One frame of the main window against the mock client, connected with the
+// given number of stations, as --mock-client runs it. There is no VATSIM
+// data, so the mock gets a session of its own.
+void BM_RenderFrame(benchmark::State& state)
+{
+    HeadlessImGui imgui;
+
+    shared::offlineMode = true;
+    // Any free port, so a running VectorAudio does not get in the way
+    shared::apiServerPort = 0;
+    shared::FetchedStations.clear();
+    {
+        const std::lock_guard<std::mutex> lock(shared::session::m);
+        shared::session::is_connected = true;
+        shared::session::callsign = "MOCK_CTR";
+        shared::session::frequency = 118000000;
+        shared::session::facility = 6;
+    }
+
+    MockAfvClient::Options options;
+    options.stations = static_cast<int>(state.range(0));
+    auto mock = std::make_unique<MockAfvClient>(options);
+    auto* client = mock.get();
+    application::App app(std::move(mock));
+
+    app.core().connect();
+    for (int i = 0; i < options.stations; i++) {
+        app.core().addStation("MOCK" + std::to_string(i) + "_APP");
+    }
+
+    constexpr auto frame_step = std::chrono::microseconds(1000000 / 30);
+    for (auto _ : state) {
+        client->advance(frame_step);
+
+        ImGui::NewFrame();
+        app.render_frame();
+        ImGui::Render();
+    }
+
+    state.counters["stations"]
+        = static_cast<double>(shared::FetchedStations.size());
+
+    app.core().disconnect(true);
+    shared::FetchedStations.clear();
+}
+BENCHMARK(BM_RenderFrame)->Arg(0)->Arg(10)->Arg(50);
+
+}
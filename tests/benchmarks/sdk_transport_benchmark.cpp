@@ -0,0 +1,134 @@
+#include "app_core.h"
+#include "mock_afv_client.h"
+#include "sdk_socket_server.h"
+#include "shared.h"
+#include <benchmark/benchmark.h>
+#include <charconv>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+
+using namespace vector_audio;
+
+namespace {
+
+namespace asio = restinio::asio_ns;
+
+// A plugin polling the SDK over one kept alive connection, the way the SDK
+// clients do
+template <typename Protocol>
+class SdkClient {
+public:
+    // The servers open asynchronously, so the first connects may be refused
+    explicit SdkClient(const typename Protocol::endpoint& endpoint)
+        : socket_(context_)
+    {
+        for (int attempt = 0; attempt < 200; attempt++) {
+            std::error_code ec;
+            socket_.connect(endpoint, ec);
+            if (!ec) {
+                return;
+            }
+            socket_.close(ec);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        throw std::runtime_error("The SDK server did not come up");
+    }
+
+    // Returns the size of the body
+    std::size_t get(const std::string& target)
+    {
+        const auto request
+            = "GET " + target + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+        asio::write(socket_, asio::buffer(request));
+
+        auto head_size = asio::read_until(
+            socket_, asio::dynamic_buffer(buffer_), "\r\n\r\n");
+        std::string_view head(buffer_.data(), head_size);
+
+        std::size_t length = 0;
+        const std::string_view length_header = "Content-Length: ";
+        auto pos = head.find(length_header);
+        if (pos != std::string_view::npos) {
+            pos += length_header.size();
+            std::from_chars(
+                head.data() + pos, head.data() + head.size(), length);
+        }
+
+        if (buffer_.size() < head_size + length) {
+            asio::read(socket_, asio::dynamic_buffer(buffer_),
+                asio::transfer_exactly(head_size + length - buffer_.size()));
+        }
+        buffer_.erase(0, head_size + length);
+        return length;
+    }
+
+private:
+    asio::io_context context_;
+    typename Protocol::socket socket_;
+    std::string buffer_;
+};
+
+// A port nothing listens on right now
+int freePort()
+{
+    asio::io_context context;
+    asio::ip::tcp::acceptor acceptor(context,
+        asio::ip::tcp::endpoint(asio::ip::make_address("127.0.0.1"), 0));
+    return acceptor.local_endpoint().port();
+}
+
+// A core against the mock, serving the SDK on both transports as the app does
+// with general.api_socket set
+std::unique_ptr<application::AppCore> sdkCore(
+    const std::filesystem::path& socket)
+{
+    shared::offlineMode = true;
+    shared::apiServerPort = freePort();
+    shared::apiServerSocket = socket.string();
+    return std::make_unique<application::AppCore>(
+        std::make_unique<MockAfvClient>(MockAfvClient::Options {}));
+}
+
+template <typename Protocol>
+void requestLoop(
+    benchmark::State& state, const typename Protocol::endpoint& endpoint)
+{
+    SdkClient<Protocol> client(endpoint);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(client.get("/transmitting"));
+    }
+}
+
+// One request and its response over loopback TCP, through restinio
+void BM_SdkRequestTcp(benchmark::State& state)
+{
+    auto socket = std::filesystem::temp_directory_path()
+        / "vector_audio_sdk_benchmark.sock";
+    auto core = sdkCore(socket);
+
+    requestLoop<asio::ip::tcp>(state,
+        asio::ip::tcp::endpoint(
+            asio::ip::make_address("127.0.0.1"), shared::apiServerPort));
+}
+BENCHMARK(BM_SdkRequestTcp)->UseRealTime();
+
+#ifdef VECTOR_HAS_SDK_SOCKET
+// The same request over the Unix domain socket
+void BM_SdkRequestSocket(benchmark::State& state)
+{
+    auto socket = std::filesystem::temp_directory_path()
+        / "vector_audio_sdk_benchmark.sock";
+    auto core = sdkCore(socket);
+
+    requestLoop<asio::local::stream_protocol>(
+        state, asio::local::stream_protocol::endpoint(socket.string()));
+}
+BENCHMARK(BM_SdkRequestSocket)->UseRealTime();
+#endif
+
+}
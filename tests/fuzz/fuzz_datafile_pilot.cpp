@@ -0,0 +1,16 @@
+#include "offline_handler.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+using vector_audio::testing::findPilotInDatafile;
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size)
+{
+    std::string input(reinterpret_cast<const char*>(data), size);
+    double latitude = 0.0;
+    double longitude = 0.0;
+    // The pilot at the end of the datafile fixture
+    findPilotInDatafile(input, "DLH4AB", latitude, longitude);
+    return 0;
+}
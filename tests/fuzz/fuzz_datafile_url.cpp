@@ -0,0 +1,27 @@
+#include "vatsim_parsers.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+using namespace vector_audio::vatsim;
+
+// The input is tried both as a whole status file and as a single URL, the
+// way getLatestDatafileURL reads them
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size)
+{
+    std::string input(reinterpret_cast<const char*>(data), size);
+    std::string host;
+    std::string path;
+
+    for (const auto& url : parsers::parseStatusFile(input)) {
+        parsers::splitDatafileUrl(url, host, path);
+    }
+
+    if (parsers::splitDatafileUrl(input, host, path)) {
+        // httplib takes the path as the request target
+        if (path.empty() || path.front() != '/') {
+            __builtin_trap();
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,14 @@
+#include "offline_handler.h"
+#include "shared.h"
+#include <spdlog/spdlog.h>
+
+// Shared by all the fuzzers, libFuzzer calls it once before the first input
+extern "C" int LLVMFuzzerInitialize(int* /*argc*/, char*** /*argv*/)
+{
+    // The parsers log every malformed input, which would drown the fuzzer
+    spdlog::set_level(spdlog::level::off);
+
+    // So that the datafile seeds from tests/fixtures find our session
+    vector_audio::shared::vatsim_cid = vector_audio::testing::kFixtureCid;
+    return 0;
+}
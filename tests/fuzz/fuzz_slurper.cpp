@@ -0,0 +1,14 @@
+#include "offline_handler.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+using namespace vector_audio::testing;
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size)
+{
+    static const auto url = slurperSessionUrl();
+    std::string input(reinterpret_cast<const char*>(data), size);
+    offlineHandler().replayResponse(url, 200, input);
+    return 0;
+}
@@ -0,0 +1,14 @@
+#include "vatsim_parsers.h"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size)
+{
+    std::string_view input(reinterpret_cast<const char*>(data), size);
+    double latitude = 0.0;
+    double longitude = 0.0;
+    vector_audio::vatsim::parsers::parsePilotPositionFromSlurper(
+        input, latitude, longitude);
+    return 0;
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace vector_audio::testing {
+
+// Reads one of the sample responses in tests/fixtures
+inline std::string loadFixture(const std::string& name)
+{
+    auto path = std::filesystem::path(VECTOR_FIXTURES_DIR) / name;
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Missing fixture " + path.string());
+    }
+
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    return buffer.str();
+}
+
+}
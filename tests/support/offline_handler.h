@@ -0,0 +1,57 @@
+#pragma once
+#include "data_file_handler.h"
+#include "datafile_stream.h"
+#include "event_loop.h"
+#include "shared.h"
+#include "vatsim_parsers.h"
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <string>
+
+namespace vector_audio::testing {
+
+// The CID of the controller in the datafile and slurper fixtures
+constexpr int kFixtureCid = 1234567;
+
+// A handler that never polls, built once for the whole run. Responses go in
+// through replayResponse, down the same path as a session check.
+inline vatsim::DataHandler& offlineHandler()
+{
+    static EventLoop loop(1, 1);
+    static auto handler = [] {
+        shared::offlineMode = true;
+        return std::make_unique<vatsim::DataHandler>(loop);
+    }();
+    return *handler;
+}
+
+// The URL our own session is checked on, any other URL that is not the
+// status file or the bare slurper is taken as a datafile
+inline std::string slurperSessionUrl()
+{
+    return std::string(slurper_url) + std::to_string(shared::vatsim_cid);
+}
+
+inline const std::string kDatafileUrl = "/v3/vatsim-data.json";
+
+// The pilot lookup of getPilotPositionWithDatafile, on a datafile that is
+// already in memory rather than streamed from a mirror
+inline bool findPilotInDatafile(const std::string& data,
+    const std::string& callsign, double& latitude, double& longitude)
+{
+    vatsim::DatafileSax sax({ "pilots" },
+        [&](const std::string& /*array*/, const nlohmann::json& pilot) {
+            return vatsim::parsers::matchPilot(
+                pilot, callsign, latitude, longitude);
+        });
+
+    try {
+        nlohmann::json::sax_parse(data, &sax);
+    } catch (std::exception&) {
+        return false;
+    }
+
+    return sax.found();
+}
+
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <chrono>
+#include <functional>
+#include <httplib.h>
+#include <string>
+#include <thread>
+
+namespace vector_audio::testing {
+
+// A local HTTP server standing in for a VATSIM endpoint, on a free port of
+// the loopback interface. The routes are set up before it starts listening,
+// its handlers run on the server's own threads.
+class StandInServer {
+public:
+    explicit StandInServer(const std::function<void(httplib::Server&)>& routes)
+    {
+        routes(server_);
+        port_ = server_.bind_to_any_port("127.0.0.1");
+        thread_ = std::thread([this] { server_.listen_after_bind(); });
+
+        while (!server_.is_running()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    ~StandInServer()
+    {
+        server_.stop();
+        thread_.join();
+    }
+
+    StandInServer(const StandInServer&) = delete;
+    StandInServer& operator=(const StandInServer&) = delete;
+
+    // In the form httplib::Client and the status file take
+    std::string host() const
+    {
+        return "http://127.0.0.1:" + std::to_string(port_);
+    }
+
+private:
+    httplib::Server server_;
+    int port_ = 0;
+    std::thread thread_;
+};
+
+// Polls until the condition holds or the timeout runs out, and returns the
+// condition
+inline bool waitFor(
+    const std::function<bool()>& condition, std::chrono::milliseconds timeout)
+{
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return true;
+}
+
+}
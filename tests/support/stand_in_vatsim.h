@@ -0,0 +1,176 @@
+#pragma once
+#include "data_file_handler.h"
+#include "event_loop.h"
+#include "fixtures.h"
+#include "offline_handler.h"
+#include "shared.h"
+#include "stand_in_server.h"
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <httplib.h>
+#include <memory>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace vector_audio::testing {
+
+// The route of slurper_url. httplib matches routes as regexes against the path
+// without its query, so the URL itself never matches.
+inline const std::string kSlurperRoute = "/users/info/";
+
+// A datafile mirror answering after a fixed delay, HEAD probes included. It
+// counts the full downloads, and can be made to fail them.
+class MirrorStandIn {
+public:
+    explicit MirrorStandIn(std::chrono::milliseconds delay, bool down = false,
+        std::string datafile = loadFixture("vatsim-data.json"))
+        : datafile_(std::move(datafile))
+        , failing_(down)
+        , server_([this, delay](httplib::Server& s) {
+            s.Get(kDatafileUrl,
+                [this, delay](
+                    const httplib::Request& req, httplib::Response& res) {
+                    std::this_thread::sleep_for(delay);
+                    if (req.method == "GET") {
+                        downloads_++;
+                    }
+                    if (failing_) {
+                        res.status = 503;
+                        return;
+                    }
+                    res.set_content(datafile_, "application/json");
+                });
+        })
+    {
+    }
+
+    std::string url() const { return server_.host() + kDatafileUrl; }
+    int downloads() const { return downloads_; }
+    void fail() { failing_ = true; }
+
+private:
+    const std::string datafile_;
+    std::atomic<int> downloads_ = 0;
+    std::atomic<bool> failing_;
+    StandInServer server_;
+};
+
+// The slurper, answering our session check with the controller fixture after
+// a delay. A slurper that is down answers nothing, not even to the probe.
+class SlurperStandIn {
+public:
+    explicit SlurperStandIn(std::chrono::milliseconds delay, bool up = true)
+        : server_([this, delay, up](httplib::Server& s) {
+            if (!up) {
+                return;
+            }
+            s.Get(kSlurperRoute,
+                [this, delay](
+                    const httplib::Request& req, httplib::Response& res) {
+                    // The availability probe sends an empty cid
+                    if (req.get_param_value("cid").empty()) {
+                        res.set_content("Must Provide CID", "text/plain");
+                        return;
+                    }
+                    std::this_thread::sleep_for(delay);
+                    checks_++;
+                    res.set_content(session_, "text/plain");
+                });
+        })
+    {
+    }
+
+    std::string host() const { return server_.host(); }
+    int checks() const { return checks_; }
+
+private:
+    const std::string session_ = loadFixture("slurper_controller.txt");
+    std::atomic<int> checks_ = 0;
+    StandInServer server_;
+};
+
+// A status file listing the mirrors in the given order, plus the slurper,
+// standing in for the whole of VATSIM
+class VatsimStandIn {
+public:
+    VatsimStandIn(const SlurperStandIn& slurper,
+        const std::vector<const MirrorStandIn*>& mirrors)
+        : slurper_host_(slurper.host())
+        , status_([&mirrors](httplib::Server& s) {
+            nlohmann::json urls = nlohmann::json::array();
+            for (const auto* mirror : mirrors) {
+                urls.push_back(mirror->url());
+            }
+            auto status
+                = nlohmann::json { { "data", { { "v3", urls } } } }.dump();
+
+            s.Get(vatsim_status_url,
+                [status](const httplib::Request&, httplib::Response& res) {
+                    res.set_content(status, "application/json");
+                });
+        })
+    {
+    }
+
+    // Never cached, the tests stay out of the user's config folder
+    vatsim::Endpoints endpoints() const
+    {
+        vatsim::Endpoints endpoints;
+        endpoints.status_server = status_.host();
+        endpoints.slurper_server = slurper_host_;
+        endpoints.use_cache = false;
+        return endpoints;
+    }
+
+private:
+    std::string slurper_host_;
+    StandInServer status_;
+};
+
+// Handlers that poll share the session with the rest of the app, so each test
+// starts from a clean one as our fixture controller
+class PollingHandlerTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        shared::offlineMode = false;
+        shared::vatsim_cid = kFixtureCid;
+    }
+
+    void TearDown() override
+    {
+        handler_.reset();
+
+        const std::lock_guard<std::mutex> l(shared::session::m);
+        shared::session::is_connected = false;
+        shared::session::callsign.clear();
+    }
+
+    void start(const VatsimStandIn& vatsim)
+    {
+        handler_ = std::make_unique<vatsim::DataHandler>(
+            loop_, vatsim.endpoints());
+    }
+
+    // The first poll probes the endpoints and checks the session, the next
+    // one is poll_interval away
+    static bool firstPollDone()
+    {
+        return waitFor(
+            [] {
+                const std::lock_guard<std::mutex> l(shared::session::m);
+                return shared::session::is_connected;
+            },
+            std::chrono::seconds(10));
+    }
+
+    EventLoop loop_ { 1, 2 };
+    std::unique_ptr<vatsim::DataHandler> handler_;
+};
+
+}
@@ -0,0 +1,186 @@
+#include "fixtures.h"
+#include "stand_in_vatsim.h"
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+using namespace vector_audio;
+using namespace vector_audio::testing;
+using namespace std::chrono_literals;
+
+namespace {
+
+// A body in the given Content-Encoding, gzip or deflate (a zlib stream)
+std::string compress(const std::string& data, const std::string& encoding)
+{
+    // 16 on top of the window size writes a gzip header instead of zlib's
+    z_stream stream {};
+    deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED,
+        encoding == "gzip" ? MAX_WBITS + 16 : MAX_WBITS, 8,
+        Z_DEFAULT_STRATEGY);
+
+    std::string out(deflateBound(&stream, static_cast<uLong>(data.size())), 0);
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(out.data());
+    stream.avail_out = static_cast<uInt>(out.size());
+    deflate(&stream, Z_FINISH);
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+    return out;
+}
+
+// The same body with its second half garbled
+std::string corrupt(std::string body)
+{
+    for (auto i = body.size() / 2; i < body.size(); i++) {
+        body[i] = static_cast<char>(body[i] ^ 0x5A);
+    }
+    return body;
+}
+
+// VATSIM answering everything compressed. Once corrupted, our session check
+// and the datafile come in garbled, the probes still answer.
+class CompressedVatsimStandIn {
+public:
+    explicit CompressedVatsimStandIn(const std::string& encoding)
+        : encoding_(encoding)
+        , mirror_([this](httplib::Server& s) {
+            auto datafile
+                = compress(loadFixture("vatsim-data.json"), encoding_);
+            s.Get(kDatafileUrl,
+                [this, datafile](
+                    const httplib::Request&, httplib::Response& res) {
+                    answer(res, corrupted_ ? corrupt(datafile) : datafile);
+                });
+        })
+        , vatsim_([this](httplib::Server& s) {
+            nlohmann::json urls { mirror_.host() + kDatafileUrl };
+            auto status = compress(
+                nlohmann::json { { "data", { { "v3", urls } } } }.dump(),
+                encoding_);
+            s.Get(vatsim_status_url,
+                [this, status](
+                    const httplib::Request&, httplib::Response& res) {
+                    answer(res, status);
+                });
+
+            auto probe = compress("Must Provide CID", encoding_);
+            auto session
+                = compress(loadFixture("slurper_controller.txt"), encoding_);
+            s.Get(kSlurperRoute,
+                [this, probe, session](
+                    const httplib::Request& req, httplib::Response& res) {
+                    if (req.get_param_value("cid").empty()) {
+                        answer(res, probe);
+                        return;
+                    }
+                    checks_++;
+                    answer(res, corrupted_ ? corrupt(session) : session);
+                });
+        })
+    {
+    }
+
+    vatsim::Endpoints endpoints() const
+    {
+        vatsim::Endpoints endpoints;
+        endpoints.status_server = vatsim_.host();
+        endpoints.slurper_server = vatsim_.host();
+        endpoints.use_cache = false;
+        endpoints.poll_interval = 100ms;
+        return endpoints;
+    }
+
+    int checks() const { return checks_; }
+    void corruptSession() { corrupted_ = true; }
+
+private:
+    // Not a type httplib would compress a second time
+    void answer(httplib::Response& res, const std::string& body) const
+    {
+        res.set_content(body, "application/octet-stream");
+        res.set_header("Content-Encoding", encoding_);
+    }
+
+    const std::string encoding_;
+    std::atomic<int> checks_ = 0;
+    std::atomic<bool> corrupted_ = false;
+    StandInServer mirror_;
+    StandInServer vatsim_;
+};
+
+class CompressedResponses
+    : public PollingHandlerTest,
+      public ::testing::WithParamInterface<std::string> {
+protected:
+    void start(const CompressedVatsimStandIn& vatsim)
+    {
+        handler_ = std::make_unique<vatsim::DataHandler>(
+            loop_, vatsim.endpoints());
+    }
+
+    static std::string callsign()
+    {
+        const std::lock_guard<std::mutex> l(shared::session::m);
+        return shared::session::callsign;
+    }
+
+    static bool connected()
+    {
+        const std::lock_guard<std::mutex> l(shared::session::m);
+        return shared::session::is_connected;
+    }
+};
+
+TEST_P(CompressedResponses, AreDecodedAsTheyArrive)
+{
+    CompressedVatsimStandIn vatsim(GetParam());
+    auto before = vatsim::DataHandler::transferStats();
+    start(vatsim);
+    ASSERT_TRUE(firstPollDone());
+    EXPECT_EQ(callsign(), "LFPG_TWR");
+
+    // A subscriber has the datafile read on every poll. The counts are added
+    // once a download is over.
+    auto datafile_size = loadFixture("vatsim-data.json").size();
+    auto id = handler_->subscribeToChanges(
+        [](const std::vector<vatsim::DatafileChange>&) {});
+    ASSERT_TRUE(waitFor(
+        [&] {
+            auto stats = vatsim::DataHandler::transferStats();
+            return stats.decoded_bytes - before.decoded_bytes > datafile_size;
+        },
+        5s));
+    handler_->unsubscribeFromChanges(id);
+
+    auto after = vatsim::DataHandler::transferStats();
+    auto wire = after.wire_bytes - before.wire_bytes;
+    auto decoded = after.decoded_bytes - before.decoded_bytes;
+    EXPECT_GT(wire, 0U);
+    EXPECT_LT(wire, decoded);
+}
+
+// A garbled answer is no answer, not a disconnect, however many polls get one
+TEST_P(CompressedResponses, CorruptStreamKeepsTheSession)
+{
+    CompressedVatsimStandIn vatsim(GetParam());
+    start(vatsim);
+    ASSERT_TRUE(firstPollDone());
+
+    vatsim.corruptSession();
+    auto checks = vatsim.checks();
+    ASSERT_TRUE(waitFor([&] { return vatsim.checks() >= checks + 4; }, 5s));
+
+    EXPECT_TRUE(connected());
+    EXPECT_EQ(callsign(), "LFPG_TWR");
+}
+
+INSTANTIATE_TEST_SUITE_P(Encodings, CompressedResponses,
+    ::testing::Values("gzip", "deflate"));
+
+}
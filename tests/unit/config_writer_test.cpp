@@ -0,0 +1,163 @@
+#include "config.h"
+#include "shared.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <thread>
+#include <toml.hpp>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+using namespace vector_audio;
+using namespace std::chrono_literals;
+
+namespace {
+
+// Threads of the whole process, 0 where /proc is not there to tell
+std::size_t threadCount()
+{
+    std::error_code ec;
+    std::filesystem::directory_iterator tasks("/proc/self/task", ec);
+    if (ec) {
+        return 0;
+    }
+    return static_cast<std::size_t>(
+        std::distance(tasks, std::filesystem::directory_iterator()));
+}
+
+// The config folder comes from the environment, so each run moves it to a
+// folder of its own rather than touching the user's config
+class ConfigWriter : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        folder_ = std::filesystem::temp_directory_path()
+            / ("vector_audio_config_test_" + std::to_string(getpid()));
+        std::filesystem::create_directories(folder_);
+
+        for (const char* name : { "XDG_CONFIG_HOME", "HOME" }) {
+            const char* value = std::getenv(name);
+            saved_env_.emplace_back(name,
+                value ? std::optional<std::string>(value) : std::nullopt);
+            setenv(name, folder_.c_str(), 1);
+        }
+    }
+
+    void TearDown() override
+    {
+        Configuration::stop_config_writer();
+
+        for (const auto& [name, value] : saved_env_) {
+            if (value) {
+                setenv(name.c_str(), value->c_str(), 1);
+            } else {
+                unsetenv(name.c_str());
+            }
+        }
+
+        std::filesystem::remove_all(folder_);
+    }
+
+    static std::filesystem::path configFile()
+    {
+        return Configuration::get_config_folder_path()
+            / Configuration::config_file_name_;
+    }
+
+    static void saveVersion(int i)
+    {
+        shared::lastSeenVersion = "1.0." + std::to_string(i);
+        Configuration::save_setting("updater", "last_version");
+    }
+
+    std::filesystem::path folder_;
+    std::vector<std::pair<std::string, std::optional<std::string>>>
+        saved_env_;
+};
+
+TEST_F(ConfigWriter, CoalescesABurstIntoOneWrite)
+{
+    auto threads_before = threadCount();
+    auto max_threads = threads_before;
+    auto writes_before = Configuration::config_file_writes();
+
+    for (int i = 0; i < 1000; i++) {
+        saveVersion(i);
+        max_threads = std::max(max_threads, threadCount());
+    }
+    Configuration::stop_config_writer();
+
+    // A single writer thread for the whole burst
+    if (threads_before > 0) {
+        EXPECT_LE(max_threads, threads_before + 1);
+    }
+
+    // Once for the burst, and once more if a write came in while the file
+    // was being written
+    EXPECT_LE(Configuration::config_file_writes() - writes_before, 2U);
+
+    auto config = toml::parse(configFile().string());
+    EXPECT_EQ(toml::find<std::string>(config, "updater", "last_version"),
+        "1.0.999");
+    EXPECT_FALSE(std::filesystem::exists(configFile().string() + ".tmp"));
+}
+
+// Changes coming in faster than the quiet window still get written, a crash
+// halfway through a long stream loses at most kConfigWriteMaxDelay of them
+TEST_F(ConfigWriter, FlushesASteadyStream)
+{
+    auto writes_before = Configuration::config_file_writes();
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; std::chrono::steady_clock::now() - start
+         < 3 * Configuration::kConfigWriteMaxDelay;
+         i++) {
+        saveVersion(i);
+        std::this_thread::sleep_for(Configuration::kConfigWriteDelay / 2);
+    }
+
+    EXPECT_GE(Configuration::config_file_writes() - writes_before, 2U);
+}
+
+TEST_F(ConfigWriter, NeverLeavesAPartialFile)
+{
+    saveVersion(0);
+    Configuration::stop_config_writer();
+
+    std::atomic<bool> done = false;
+    int reads = 0;
+    int failed_reads = 0;
+    std::thread reader([&] {
+        while (!done) {
+            try {
+                toml::parse(configFile().string());
+                reads++;
+            } catch (std::exception&) {
+                failed_reads++;
+            }
+        }
+    });
+
+    // Spaced out past the coalescing delay, so they are written one by one
+    auto writes_before = Configuration::config_file_writes();
+    for (int i = 1; i <= 10; i++) {
+        saveVersion(i);
+        std::this_thread::sleep_for(400ms);
+    }
+
+    done = true;
+    reader.join();
+
+    EXPECT_GE(Configuration::config_file_writes() - writes_before, 5U);
+    EXPECT_GT(reads, 0);
+    EXPECT_EQ(failed_reads, 0);
+}
+
+}
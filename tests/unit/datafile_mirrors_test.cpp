@@ -0,0 +1,76 @@
+#include "fixtures.h"
+#include "offline_handler.h"
+#include "stand_in_vatsim.h"
+#include <chrono>
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+using namespace vector_audio::testing;
+using namespace std::chrono_literals;
+
+namespace {
+
+// The slurper is down, so every session check goes to the datafile
+using DatafileMirrors = PollingHandlerTest;
+
+TEST_F(DatafileMirrors, DownloadsFromTheFastestHealthyMirror)
+{
+    SlurperStandIn slurper(0ms, false);
+    MirrorStandIn slow(400ms);
+    MirrorStandIn down(0ms, true);
+    MirrorStandIn medium(150ms);
+    MirrorStandIn fast(0ms);
+    VatsimStandIn vatsim(slurper, { &slow, &down, &medium, &fast });
+    start(vatsim);
+
+    ASSERT_TRUE(firstPollDone());
+    EXPECT_TRUE(handler_->isDatafileAvailable());
+    EXPECT_GE(fast.downloads(), 1);
+    EXPECT_EQ(medium.downloads(), 0);
+    EXPECT_EQ(slow.downloads(), 0);
+}
+
+TEST_F(DatafileMirrors, FailsOverWithinTheSameCheck)
+{
+    SlurperStandIn slurper(0ms, false);
+    MirrorStandIn slow(400ms);
+    MirrorStandIn medium(150ms);
+    MirrorStandIn fast(0ms);
+    VatsimStandIn vatsim(slurper, { &slow, &medium, &fast });
+    start(vatsim);
+    ASSERT_TRUE(firstPollDone());
+
+    // No probe runs in between, so only the failed download can tell the
+    // handler to move on
+    fast.fail();
+    EXPECT_TRUE(handler_->checkSessionNow());
+    EXPECT_EQ(medium.downloads(), 1);
+    EXPECT_EQ(slow.downloads(), 0);
+
+    // The failed mirror stays down until the next probe
+    EXPECT_TRUE(handler_->checkSessionNow());
+    EXPECT_EQ(medium.downloads(), 2);
+}
+
+// One entry the session check cannot read, ahead of our own, must not take
+// the mirror down with it
+TEST_F(DatafileMirrors, SkipsAMalformedEntry)
+{
+    auto datafile = nlohmann::json::parse(loadFixture("vatsim-data.json"));
+    auto& controllers = datafile["controllers"];
+    controllers.insert(controllers.begin(),
+        nlohmann::json { { "cid", kFixtureCid }, { "callsign", 42 },
+            { "frequency", "199.998" }, { "facility", 0 } });
+
+    SlurperStandIn slurper(0ms, false);
+    MirrorStandIn mirror(0ms, false, datafile.dump());
+    VatsimStandIn vatsim(slurper, { &mirror });
+    start(vatsim);
+
+    ASSERT_TRUE(firstPollDone());
+    EXPECT_TRUE(handler_->isDatafileAvailable());
+    EXPECT_TRUE(handler_->checkSessionNow());
+    EXPECT_EQ(mirror.downloads(), 2);
+}
+
+}
@@ -0,0 +1,93 @@
+#include "fixtures.h"
+#include "replay.h"
+#include "shared.h"
+#include "stand_in_vatsim.h"
+#include <chrono>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <vector>
+
+using namespace vector_audio;
+using namespace vector_audio::testing;
+using namespace std::chrono_literals;
+
+namespace {
+
+// The slurper is down, so the session is checked on the datafile
+class ReplayRecording : public PollingHandlerTest {
+protected:
+    void TearDown() override
+    {
+        replay::Recorder::stop();
+        std::filesystem::remove(path_);
+        PollingHandlerTest::TearDown();
+    }
+
+    std::vector<replay::Record> datafileRecords()
+    {
+        replay::Recorder::stop();
+
+        std::vector<replay::Record> records;
+        replay::LogReader reader(path_);
+        replay::Record record;
+        while (reader.next(record)) {
+            if (record.kind == replay::RecordKind::HttpResponse
+                && record.detail == kDatafileUrl) {
+                records.push_back(record);
+            }
+        }
+        return records;
+    }
+
+    const std::filesystem::path path_
+        = std::filesystem::temp_directory_path() / "vector_replay_test.bin";
+};
+
+TEST_F(ReplayRecording, KeepsOnlyTheControllersUpToOurs)
+{
+    SlurperStandIn slurper(0ms, false);
+    MirrorStandIn mirror(0ms);
+    VatsimStandIn vatsim(slurper, { &mirror });
+    ASSERT_TRUE(replay::Recorder::start(path_));
+    start(vatsim);
+    ASSERT_TRUE(firstPollDone());
+
+    auto records = datafileRecords();
+    ASSERT_EQ(records.size(), 1U);
+    EXPECT_EQ(records.front().code, 200U);
+    EXPECT_LT(records.front().payload.size(),
+        loadFixture("vatsim-data.json").size());
+
+    auto recorded = nlohmann::json::parse(records.front().payload);
+    ASSERT_EQ(recorded.size(), 1U);
+    ASSERT_TRUE(recorded.contains("controllers"));
+    EXPECT_EQ(recorded["controllers"].back()["cid"], kFixtureCid);
+}
+
+TEST_F(ReplayRecording, ReplayedCheckFindsTheSession)
+{
+    SlurperStandIn slurper(0ms, false);
+    MirrorStandIn mirror(0ms);
+    VatsimStandIn vatsim(slurper, { &mirror });
+    ASSERT_TRUE(replay::Recorder::start(path_));
+    start(vatsim);
+    ASSERT_TRUE(firstPollDone());
+
+    auto records = datafileRecords();
+    ASSERT_FALSE(records.empty());
+    {
+        const std::lock_guard<std::mutex> l(shared::session::m);
+        shared::session::is_connected = false;
+        shared::session::callsign.clear();
+    }
+
+    handler_->replayResponse(records.front().detail,
+        static_cast<int>(records.front().code), records.front().payload);
+
+    const std::lock_guard<std::mutex> l(shared::session::m);
+    EXPECT_TRUE(shared::session::is_connected);
+}
+
+}
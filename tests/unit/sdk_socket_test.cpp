@@ -0,0 +1,180 @@
+#include "event_loop.h"
+#include "sdk_socket_server.h"
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#ifdef VECTOR_HAS_SDK_SOCKET
+
+using namespace vector_audio;
+
+namespace {
+
+namespace asio = restinio::asio_ns;
+
+// A plain blocking client, the way a plugin would talk to the socket
+class SocketClient {
+public:
+    explicit SocketClient(const std::filesystem::path& path)
+        : socket_(context_)
+    {
+        socket_.connect(asio::local::stream_protocol::endpoint(path.string()));
+    }
+
+    void send(const std::string& request)
+    {
+        asio::write(socket_, asio::buffer(request));
+    }
+
+    // The body of the next response, which must be a 200
+    std::string receive()
+    {
+        auto head_size = asio::read_until(
+            socket_, asio::dynamic_buffer(buffer_), "\r\n\r\n");
+        std::string head = buffer_.substr(0, head_size);
+        EXPECT_EQ(head.rfind("HTTP/1.1 200 OK\r\n", 0), 0U) << head;
+
+        const std::string_view length_header = "Content-Length: ";
+        auto pos = head.find(length_header);
+        EXPECT_NE(pos, std::string::npos) << head;
+        std::size_t length = 0;
+        if (pos != std::string::npos) {
+            pos += length_header.size();
+            std::from_chars(
+                head.data() + pos, head.data() + head.size(), length);
+        }
+
+        if (buffer_.size() < head_size + length) {
+            asio::read(socket_, asio::dynamic_buffer(buffer_),
+                asio::transfer_exactly(head_size + length - buffer_.size()));
+        }
+
+        auto body = buffer_.substr(head_size, length);
+        buffer_.erase(0, head_size + length);
+        return body;
+    }
+
+    std::string get(const std::string& target, bool keep_alive = true)
+    {
+        send("GET " + target + " HTTP/1.1\r\nHost: localhost\r\n"
+            + (keep_alive ? "" : "Connection: close\r\n") + "\r\n");
+        return receive();
+    }
+
+    // Whether the server closed its end
+    bool closed()
+    {
+        char byte = 0;
+        std::error_code ec;
+        socket_.read_some(asio::buffer(&byte, 1), ec);
+        return ec == asio::error::eof;
+    }
+
+private:
+    asio::io_context context_;
+    asio::local::stream_protocol::socket socket_;
+    std::string buffer_;
+};
+
+class SDKSocket : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        path_ = std::filesystem::temp_directory_path()
+            / ("vector_audio_sdk_test_"
+                + std::to_string(std::chrono::steady_clock::now()
+                                     .time_since_epoch()
+                                     .count())
+                + ".sock");
+        start();
+    }
+
+    void TearDown() override { server_.reset(); }
+
+    void start()
+    {
+        server_ = std::make_unique<SDKSocketServer>(
+            loop_, path_, [this](bool is_get, std::string_view target) {
+                requests_++;
+                return std::string(is_get ? "GET " : "POST ")
+                    + std::string(target);
+            });
+    }
+
+    EventLoop loop_ { 1, 1 };
+    std::filesystem::path path_;
+    std::atomic<int> requests_ = 0;
+    std::unique_ptr<SDKSocketServer> server_;
+};
+
+TEST_F(SDKSocket, ServesTheSdkRoutes)
+{
+    SocketClient client(path_);
+    EXPECT_EQ(client.get("/transmitting"), "GET /transmitting");
+    EXPECT_EQ(requests_, 1);
+}
+
+TEST_F(SDKSocket, KeepsTheConnectionAlive)
+{
+    SocketClient client(path_);
+    EXPECT_EQ(client.get("/rx"), "GET /rx");
+    EXPECT_EQ(client.get("/tx"), "GET /tx");
+
+    // Pipelined, with a body that has to be skipped in between
+    client.send("POST /rx HTTP/1.1\r\nContent-Length: 4\r\n\r\nbodyGET /tx "
+                "HTTP/1.1\r\n\r\n");
+    EXPECT_EQ(client.receive(), "POST /rx");
+    EXPECT_EQ(client.receive(), "GET /tx");
+    EXPECT_EQ(requests_, 4);
+}
+
+TEST_F(SDKSocket, ClosesWhenAsked)
+{
+    SocketClient client(path_);
+    EXPECT_EQ(client.get("/rx", false), "GET /rx");
+    EXPECT_TRUE(client.closed());
+}
+
+TEST_F(SDKSocket, OnlyTheOwnerCanConnect)
+{
+    auto perms = std::filesystem::status(path_).permissions();
+    EXPECT_EQ(perms & std::filesystem::perms::all,
+        std::filesystem::perms::owner_read
+            | std::filesystem::perms::owner_write);
+}
+
+TEST_F(SDKSocket, RemovesTheSocketOnShutdown)
+{
+    // An open connection does not hold the shutdown up either
+    SocketClient client(path_);
+    EXPECT_EQ(client.get("/rx"), "GET /rx");
+
+    server_.reset();
+    EXPECT_FALSE(std::filesystem::exists(path_));
+    EXPECT_TRUE(client.closed());
+}
+
+TEST_F(SDKSocket, ReplacesAStaleSocket)
+{
+    // As left behind by a crash
+    server_.reset();
+    {
+        asio::io_context context;
+        asio::local::stream_protocol::acceptor stale(context,
+            asio::local::stream_protocol::endpoint(path_.string()));
+    }
+    ASSERT_TRUE(std::filesystem::is_socket(path_));
+
+    start();
+    SocketClient client(path_);
+    EXPECT_EQ(client.get("/rx"), "GET /rx");
+}
+
+}
+
+#endif
@@ -0,0 +1,50 @@
+#include "stand_in_vatsim.h"
+#include <chrono>
+#include <gtest/gtest.h>
+
+using namespace vector_audio::testing;
+using namespace std::chrono_literals;
+
+namespace {
+
+// Until there are enough slurper samples, the datafile goes out once the
+// slurper took longer than the default hedge delay of a second
+using SessionCheck = PollingHandlerTest;
+
+TEST_F(SessionCheck, FastSlurperIsNotHedged)
+{
+    SlurperStandIn slurper(0ms);
+    MirrorStandIn mirror(0ms);
+    VatsimStandIn vatsim(slurper, { &mirror });
+    start(vatsim);
+    ASSERT_TRUE(firstPollDone());
+
+    EXPECT_TRUE(handler_->checkSessionNow());
+
+    auto stats = handler_->sessionCheckStats();
+    EXPECT_EQ(stats.checks, 2U);
+    EXPECT_EQ(stats.hedged, 0U);
+    EXPECT_EQ(slurper.checks(), 2);
+    EXPECT_EQ(mirror.downloads(), 0);
+}
+
+TEST_F(SessionCheck, SlowSlurperIsAnsweredByTheDatafile)
+{
+    SlurperStandIn slurper(3s);
+    MirrorStandIn mirror(0ms);
+    VatsimStandIn vatsim(slurper, { &mirror });
+    start(vatsim);
+    ASSERT_TRUE(firstPollDone());
+
+    auto began = std::chrono::steady_clock::now();
+    EXPECT_TRUE(handler_->checkSessionNow());
+    EXPECT_LT(std::chrono::steady_clock::now() - began, 3s);
+
+    auto stats = handler_->sessionCheckStats();
+    EXPECT_EQ(stats.checks, 2U);
+    EXPECT_EQ(stats.hedged, 2U);
+    EXPECT_EQ(stats.datafile_won, 2U);
+    EXPECT_GE(mirror.downloads(), 2);
+}
+
+}
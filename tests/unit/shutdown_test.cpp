@@ -0,0 +1,174 @@
+#include "app_core.h"
+#include "config.h"
+#include "data_file_handler.h"
+#include "event_loop.h"
+#include "mock_afv_client.h"
+#include "shared.h"
+#include "stand_in_vatsim.h"
+#include "updater.h"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <thread>
+
+using namespace vector_audio;
+using namespace vector_audio::testing;
+using namespace std::chrono_literals;
+
+namespace {
+
+// Well under the 5s connection and 10s read timeouts of the VATSIM clients,
+// so only an aborted request gets there in time
+constexpr auto kShutdownBudget = 2s;
+
+// Takes every GET on the path and never answers it, until destroyed. HEAD
+// requests are answered, so a hanging mirror still passes its probe.
+class HangingStandIn {
+public:
+    explicit HangingStandIn(const std::string& path)
+        : server_([this, path](httplib::Server& s) {
+            s.Get(path, [this](const httplib::Request& req,
+                            httplib::Response& res) {
+                if (req.method == "HEAD") {
+                    res.set_content("{}", "application/json");
+                    return;
+                }
+                hanging_++;
+                while (!released_) {
+                    std::this_thread::sleep_for(10ms);
+                }
+            });
+        })
+    {
+    }
+
+    ~HangingStandIn() { released_ = true; }
+
+    HangingStandIn(const HangingStandIn&) = delete;
+    HangingStandIn& operator=(const HangingStandIn&) = delete;
+
+    std::string host() const { return server_.host(); }
+    int hanging() const { return hanging_; }
+
+private:
+    std::atomic<int> hanging_ = 0;
+    std::atomic<bool> released_ = false;
+    StandInServer server_;
+};
+
+template <typename T>
+std::chrono::milliseconds timeToDestroy(std::unique_ptr<T>& object)
+{
+    auto start = std::chrono::steady_clock::now();
+    object.reset();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+}
+
+using Shutdown = PollingHandlerTest;
+
+TEST_F(Shutdown, AbortsHangingEndpointProbes)
+{
+    HangingStandIn status(vatsim_status_url);
+    HangingStandIn slurper(kSlurperRoute);
+
+    vatsim::Endpoints endpoints;
+    endpoints.status_server = status.host();
+    endpoints.slurper_server = slurper.host();
+    endpoints.use_cache = false;
+    handler_ = std::make_unique<vatsim::DataHandler>(loop_, endpoints);
+
+    ASSERT_TRUE(waitFor(
+        [&] { return status.hanging() > 0 && slurper.hanging() > 0; }, 5s));
+    EXPECT_LT(timeToDestroy(handler_), kShutdownBudget);
+}
+
+TEST_F(Shutdown, AbortsAHangingDatafileDownload)
+{
+    SlurperStandIn slurper(0ms, false);
+    HangingStandIn mirror(kDatafileUrl);
+
+    // The status file lists the hanging mirror, which passes its probe and
+    // then never sends the datafile
+    StandInServer status([&mirror](httplib::Server& s) {
+        auto urls = nlohmann::json::array({ mirror.host() + kDatafileUrl });
+        auto body = nlohmann::json { { "data", { { "v3", urls } } } }.dump();
+        s.Get(vatsim_status_url,
+            [body](const httplib::Request&, httplib::Response& res) {
+                res.set_content(body, "application/json");
+            });
+    });
+
+    vatsim::Endpoints endpoints;
+    endpoints.status_server = status.host();
+    endpoints.slurper_server = slurper.host();
+    endpoints.use_cache = false;
+    handler_ = std::make_unique<vatsim::DataHandler>(loop_, endpoints);
+
+    ASSERT_TRUE(waitFor([&] { return mirror.hanging() > 0; }, 5s));
+    EXPECT_LT(timeToDestroy(handler_), kShutdownBudget);
+}
+
+// Nothing answers on this address, a connect to it hangs until it times out.
+// Hosts without a route fail it right away, which passes as well.
+TEST_F(Shutdown, AbortsAConnectToABlackholedHost)
+{
+    vatsim::Endpoints endpoints;
+    endpoints.status_server = "http://10.255.255.1";
+    endpoints.slurper_server = "http://10.255.255.1";
+    endpoints.use_cache = false;
+    handler_ = std::make_unique<vatsim::DataHandler>(loop_, endpoints);
+
+    // Well into the 5s connect timeout of the first poll
+    std::this_thread::sleep_for(500ms);
+    EXPECT_LT(timeToDestroy(handler_), kShutdownBudget);
+}
+
+// The updater is built during startup, a version endpoint that never answers
+// holds up neither that nor closing the app
+TEST(UpdaterShutdown, DoesNotWaitForAHangingVersionCheck)
+{
+    HangingStandIn version(updater::kVersionUrl);
+
+    auto start = std::chrono::steady_clock::now();
+    auto instance = std::make_unique<updater>(version.host());
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 100ms);
+
+    ASSERT_TRUE(waitFor([&] { return version.hanging() > 0; }, 5s));
+    EXPECT_LT(timeToDestroy(instance), updater::kShutdownWait + 100ms);
+}
+
+// The airport loader is joined on shutdown, and stops between entries rather
+// than going through the whole database first
+TEST(AppShutdown, JoinsTheAirportLoader)
+{
+    auto airports
+        = std::filesystem::temp_directory_path() / "vector_audio_airports.json";
+    {
+        nlohmann::json data;
+        for (int i = 0; i < 200000; i++) {
+            auto icao = "X" + std::to_string(i);
+            data[icao] = { { "icao", icao }, { "elevation", 100 },
+                { "lat", 48.0 }, { "lon", 2.0 } };
+        }
+        std::ofstream(airports) << data;
+    }
+
+    auto saved_path = Configuration::airports_db_file_path_;
+    Configuration::airports_db_file_path_ = airports.string();
+    shared::offlineMode = true;
+    shared::apiServerPort = 0;
+
+    auto core = std::make_unique<application::AppCore>(
+        std::make_unique<MockAfvClient>(MockAfvClient::Options {}));
+    EXPECT_LT(timeToDestroy(core), kShutdownBudget);
+
+    Configuration::airports_db_file_path_ = saved_path;
+    std::filesystem::remove(airports);
+}
+
+}